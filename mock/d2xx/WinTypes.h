@@ -0,0 +1,74 @@
+#ifndef SCP_MOCK_WINTYPES_H
+#define SCP_MOCK_WINTYPES_H
+
+// Windows type names used by ftd2xx.h on non-Windows platforms, laid out as
+// in the WinTypes.h shipped with the Linux/macOS D2XX driver.
+
+#include <stdint.h>
+
+typedef unsigned int        DWORD;
+typedef unsigned int        ULONG;
+typedef unsigned short      USHORT;
+typedef short               SHORT;
+typedef unsigned char       UCHAR;
+typedef unsigned short      WORD;
+typedef unsigned char       BYTE;
+typedef BYTE*               LPBYTE;
+typedef unsigned int        BOOL;
+typedef unsigned char       BOOLEAN;
+typedef char                CHAR;
+typedef BOOL*               LPBOOL;
+typedef UCHAR*              PUCHAR;
+typedef const char*         LPCSTR;
+typedef char*               PCHAR;
+typedef void*               PVOID;
+typedef void*               HANDLE;
+typedef int                 LONG;
+typedef int                 INT;
+typedef unsigned int        UINT;
+typedef char*               LPSTR;
+typedef char*               LPTSTR;
+typedef const char*         LPCTSTR;
+typedef DWORD*              LPDWORD;
+typedef WORD*               LPWORD;
+typedef ULONG*              PULONG;
+typedef LONG*               LPLONG;
+typedef PVOID               LPVOID;
+typedef void                VOID;
+typedef USHORT*             PUSHORT;
+typedef unsigned long long  ULONGLONG;
+
+typedef struct _OVERLAPPED {
+    DWORD Internal;
+    DWORD InternalHigh;
+    union {
+        struct {
+            DWORD Offset;
+            DWORD OffsetHigh;
+        };
+        PVOID Pointer;
+    };
+    HANDLE hEvent;
+} OVERLAPPED, *LPOVERLAPPED;
+
+typedef struct _SECURITY_ATTRIBUTES {
+    DWORD nLength;
+    LPVOID lpSecurityDescriptor;
+    BOOL bInheritHandle;
+} SECURITY_ATTRIBUTES, *LPSECURITY_ATTRIBUTES;
+
+typedef struct timeval SYSTEMTIME;
+typedef struct timeval FILETIME;
+
+#ifndef WINAPI
+#define WINAPI
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#endif // SCP_MOCK_WINTYPES_H
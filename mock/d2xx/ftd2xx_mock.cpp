@@ -0,0 +1,391 @@
+#include "ftd2xx_mock.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Granularity at which blocked calls re-run the simulation
+constexpr auto kPollInterval = std::chrono::microseconds(500);
+
+// Fixed-capacity byte ring
+class ByteFifo {
+public:
+    void reset(size_t capacity) {
+        buf_.assign(std::max<size_t>(capacity, 1), 0);
+        head_ = 0;
+        size_ = 0;
+    }
+    size_t size() const { return size_; }
+    size_t space() const { return buf_.size() - size_; }
+    void clear() { head_ = 0; size_ = 0; }
+
+    size_t push(const uint8_t* data, size_t n) {
+        n = std::min(n, space());
+        size_t tail = (head_ + size_) % buf_.size();
+        const size_t first = std::min(n, buf_.size() - tail);
+        memcpy(buf_.data() + tail, data, first);
+        memcpy(buf_.data(), data + first, n - first);
+        size_ += n;
+        return n;
+    }
+    // Pops up to n bytes into dst (or discards them when dst is null)
+    size_t pop(uint8_t* dst, size_t n) {
+        n = std::min(n, size_);
+        const size_t first = std::min(n, buf_.size() - head_);
+        if (dst) {
+            memcpy(dst, buf_.data() + head_, first);
+            memcpy(dst + first, buf_.data(), n - first);
+        }
+        head_ = (head_ + n) % buf_.size();
+        size_ -= n;
+        return n;
+    }
+
+private:
+    std::vector<uint8_t> buf_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+struct MockDevice {
+    std::mutex mutex;
+    std::condition_variable changed;
+    scpMockFtdiConfig config;
+    std::string serial;
+    ByteFifo tx;
+    ByteFifo rx;
+    Clock::time_point lastUpdate;
+    double txCredit = 0.0;
+    double rxCredit = 0.0;
+    uint8_t pattern = 0;
+    ULONG readTimeoutMs = 0;
+    ULONG writeTimeoutMs = 0;
+    UCHAR latencyMs = 16;
+    UCHAR bitMode = 0;
+    scpMockFtdiStats stats;
+};
+
+std::mutex g_registryMutex;
+std::set<MockDevice*> g_devices;
+scpMockFtdiStats g_closedTotals;
+bool g_haveConfig = false;
+scpMockFtdiConfig g_config;
+
+double envDouble(const char* name, double fallback) {
+    const char* v = getenv(name);
+    return v && *v ? strtod(v, nullptr) : fallback;
+}
+
+scpMockFtdiConfig currentConfig() {
+    // Caller holds g_registryMutex
+    if (!g_haveConfig) {
+        scpMockFtdiConfig c;
+        c.txBytesPerSec = envDouble("SCP_MOCK_FTDI_TX_RATE", c.txBytesPerSec);
+        c.rxBytesPerSec = envDouble("SCP_MOCK_FTDI_RX_RATE", c.rxBytesPerSec);
+        c.txBufferBytes = static_cast<size_t>(envDouble("SCP_MOCK_FTDI_TX_BUFFER", c.txBufferBytes));
+        c.rxBufferBytes = static_cast<size_t>(envDouble("SCP_MOCK_FTDI_RX_BUFFER", c.rxBufferBytes));
+        c.loopback = envDouble("SCP_MOCK_FTDI_LOOPBACK", c.loopback ? 1.0 : 0.0) != 0.0;
+        g_config = c;
+        g_haveConfig = true;
+    }
+    return g_config;
+}
+
+void addStats(scpMockFtdiStats& into, const scpMockFtdiStats& s) {
+    into.bytesWritten += s.bytesWritten;
+    into.bytesRead += s.bytesRead;
+    into.bytesDrained += s.bytesDrained;
+    into.rxOverflowBytes += s.rxOverflowBytes;
+    into.writeTimeouts += s.writeTimeouts;
+    into.readCalls += s.readCalls;
+    into.writeCalls += s.writeCalls;
+}
+
+MockDevice* lookup(FT_HANDLE handle) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto* dev = static_cast<MockDevice*>(handle);
+    return g_devices.count(dev) ? dev : nullptr;
+}
+
+void pushRx(MockDevice& d, const uint8_t* data, size_t n) {
+    const size_t accepted = d.rx.push(data, n);
+    d.stats.rxOverflowBytes += n - accepted;
+}
+
+// Runs the simulated device up to now; caller holds d.mutex
+void advance(MockDevice& d) {
+    const Clock::time_point now = Clock::now();
+    const double dt = std::chrono::duration<double>(now - d.lastUpdate).count();
+    d.lastUpdate = now;
+    bool moved = false;
+
+    // Device side consumes the tx FIFO at its rate
+    size_t drain = d.tx.size();
+    if (d.config.txBytesPerSec > 0.0) {
+        d.txCredit += dt * d.config.txBytesPerSec;
+        drain = std::min(drain, static_cast<size_t>(d.txCredit));
+        d.txCredit -= drain;
+        // An idle device does not bank bandwidth for a later burst
+        if (d.tx.size() == drain) d.txCredit = std::min(d.txCredit, 1.0);
+    }
+    if (drain > 0) {
+        uint8_t chunk[4096];
+        while (drain > 0) {
+            const size_t n = d.tx.pop(chunk, std::min(drain, sizeof(chunk)));
+            if (d.config.loopback) pushRx(d, chunk, n);
+            d.stats.bytesDrained += n;
+            drain -= n;
+        }
+        moved = true;
+    }
+
+    // Pattern generator feeds the rx FIFO (incrementing counter bytes)
+    if (d.config.rxBytesPerSec > 0.0) {
+        d.rxCredit += dt * d.config.rxBytesPerSec;
+        size_t produce = static_cast<size_t>(d.rxCredit);
+        d.rxCredit -= produce;
+        uint8_t chunk[4096];
+        while (produce > 0) {
+            const size_t n = std::min(produce, sizeof(chunk));
+            for (size_t i = 0; i < n; ++i) chunk[i] = d.pattern++;
+            pushRx(d, chunk, n);
+            produce -= n;
+        }
+        moved = true;
+    }
+
+    if (moved) d.changed.notify_all();
+}
+
+// Deadline for a blocking call; a zero timeout waits indefinitely, as in D2XX
+Clock::time_point deadlineFor(ULONG timeoutMs) {
+    return timeoutMs == 0 ? Clock::time_point::max()
+                          : Clock::now() + std::chrono::milliseconds(timeoutMs);
+}
+
+}  // namespace
+
+// ============================================================================
+// Control interface
+// ============================================================================
+
+void scpMockFtdiSetConfig(const scpMockFtdiConfig& config) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_config = config;
+    g_haveConfig = true;
+}
+
+scpMockFtdiConfig scpMockFtdiGetConfig() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    return currentConfig();
+}
+
+size_t scpMockFtdiInject(FT_HANDLE handle, const void* data, size_t length) {
+    MockDevice* d = lookup(handle);
+    if (!d || !data) return 0;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    advance(*d);
+    const size_t accepted = d->rx.push(static_cast<const uint8_t*>(data), length);
+    d->stats.rxOverflowBytes += length - accepted;
+    d->changed.notify_all();
+    return accepted;
+}
+
+scpMockFtdiStats scpMockFtdiGetStats(FT_HANDLE handle) {
+    MockDevice* d = lookup(handle);
+    if (!d) return scpMockFtdiStats();
+    std::lock_guard<std::mutex> lock(d->mutex);
+    return d->stats;
+}
+
+scpMockFtdiStats scpMockFtdiTotals() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    scpMockFtdiStats total = g_closedTotals;
+    for (MockDevice* d : g_devices) {
+        std::lock_guard<std::mutex> devLock(d->mutex);
+        addStats(total, d->stats);
+    }
+    return total;
+}
+
+void scpMockFtdiResetTotals() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_closedTotals = scpMockFtdiStats();
+    for (MockDevice* d : g_devices) {
+        std::lock_guard<std::mutex> devLock(d->mutex);
+        d->stats = scpMockFtdiStats();
+    }
+}
+
+// ============================================================================
+// D2XX subset
+// ============================================================================
+
+extern "C" {
+
+FTD2XX_API FT_STATUS WINAPI FT_OpenEx(PVOID pArg1, DWORD Flags, FT_HANDLE* pHandle) {
+    if (!pHandle) return FT_INVALID_PARAMETER;
+    *pHandle = nullptr;
+    if (!(Flags & (FT_OPEN_BY_SERIAL_NUMBER | FT_OPEN_BY_DESCRIPTION)) || !pArg1) {
+        return FT_NOT_SUPPORTED;  // Location-based opening has no meaning here
+    }
+
+    auto* d = new MockDevice;
+    d->serial = static_cast<const char*>(pArg1);
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        d->config = currentConfig();
+        g_devices.insert(d);
+    }
+    d->tx.reset(d->config.txBufferBytes);
+    d->rx.reset(d->config.rxBufferBytes);
+    d->lastUpdate = Clock::now();
+    *pHandle = d;
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_Close(FT_HANDLE ftHandle) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    {
+        std::lock_guard<std::mutex> devLock(d->mutex);
+        addStats(g_closedTotals, d->stats);
+    }
+    g_devices.erase(d);
+    delete d;
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_Read(FT_HANDLE ftHandle, LPVOID lpBuffer, DWORD dwBytesToRead,
+                                    LPDWORD lpBytesReturned) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    if (!lpBuffer || !lpBytesReturned) return FT_INVALID_PARAMETER;
+
+    std::unique_lock<std::mutex> lock(d->mutex);
+    d->stats.readCalls++;
+    const Clock::time_point deadline = deadlineFor(d->readTimeoutMs);
+    // Like the driver: return once the request is satisfied or the timeout expires
+    for (;;) {
+        advance(*d);
+        if (d->rx.size() >= dwBytesToRead || Clock::now() >= deadline) break;
+        d->changed.wait_for(lock, kPollInterval);
+    }
+    const size_t n = d->rx.pop(static_cast<uint8_t*>(lpBuffer), dwBytesToRead);
+    d->stats.bytesRead += n;
+    *lpBytesReturned = static_cast<DWORD>(n);
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_Write(FT_HANDLE ftHandle, LPVOID lpBuffer, DWORD dwBytesToWrite,
+                                     LPDWORD lpBytesWritten) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    if (!lpBuffer || !lpBytesWritten) return FT_INVALID_PARAMETER;
+
+    std::unique_lock<std::mutex> lock(d->mutex);
+    d->stats.writeCalls++;
+    const Clock::time_point deadline = deadlineFor(d->writeTimeoutMs);
+    const uint8_t* src = static_cast<const uint8_t*>(lpBuffer);
+    size_t done = 0;
+    // Blocks while the tx FIFO is full, i.e. paced by the simulated device
+    for (;;) {
+        advance(*d);
+        done += d->tx.push(src + done, dwBytesToWrite - done);
+        if (done == dwBytesToWrite) break;
+        if (Clock::now() >= deadline) {
+            d->stats.writeTimeouts++;
+            break;
+        }
+        d->changed.wait_for(lock, kPollInterval);
+    }
+    advance(*d);  // Unlimited drain and loopback take effect immediately
+    d->stats.bytesWritten += done;
+    *lpBytesWritten = static_cast<DWORD>(done);
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_GetQueueStatus(FT_HANDLE ftHandle, DWORD* dwRxBytes) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    if (!dwRxBytes) return FT_INVALID_PARAMETER;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    advance(*d);
+    *dwRxBytes = static_cast<DWORD>(d->rx.size());
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_GetStatus(FT_HANDLE ftHandle, DWORD* dwRxBytes, DWORD* dwTxBytes,
+                                         DWORD* dwEventDWord) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    advance(*d);
+    if (dwRxBytes) *dwRxBytes = static_cast<DWORD>(d->rx.size());
+    if (dwTxBytes) *dwTxBytes = static_cast<DWORD>(d->tx.size());
+    if (dwEventDWord) *dwEventDWord = 0;
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_Purge(FT_HANDLE ftHandle, ULONG Mask) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    if (Mask & FT_PURGE_RX) d->rx.clear();
+    if (Mask & FT_PURGE_TX) d->tx.clear();
+    d->changed.notify_all();
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_ResetDevice(FT_HANDLE ftHandle) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->rx.clear();
+    d->tx.clear();
+    d->txCredit = 0.0;
+    d->rxCredit = 0.0;
+    d->bitMode = 0;
+    d->lastUpdate = Clock::now();
+    d->changed.notify_all();
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_SetTimeouts(FT_HANDLE ftHandle, ULONG ReadTimeout, ULONG WriteTimeout) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->readTimeoutMs = ReadTimeout;
+    d->writeTimeoutMs = WriteTimeout;
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_SetLatencyTimer(FT_HANDLE ftHandle, UCHAR ucLatency) {
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    if (ucLatency < 2) return FT_INVALID_PARAMETER;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->latencyMs = ucLatency;
+    return FT_OK;
+}
+
+FTD2XX_API FT_STATUS WINAPI FT_SetBitMode(FT_HANDLE ftHandle, UCHAR ucMask, UCHAR ucEnable) {
+    (void)ucMask;
+    MockDevice* d = lookup(ftHandle);
+    if (!d) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lock(d->mutex);
+    d->bitMode = ucEnable;
+    return FT_OK;
+}
+
+}  // extern "C"
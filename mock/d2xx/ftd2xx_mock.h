@@ -0,0 +1,62 @@
+#ifndef FTD2XX_MOCK_H
+#define FTD2XX_MOCK_H
+
+#include "ftd2xx.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Control interface of the in-memory D2XX mock
+ *
+ * The mock implements the subset of ftd2xx.h used by scpFtdiSource
+ * (FT_OpenEx, FT_Close, FT_Read, FT_Write, FT_GetQueueStatus, FT_GetStatus,
+ * FT_Purge, FT_ResetDevice, FT_SetBitMode, FT_SetLatencyTimer,
+ * FT_SetTimeouts). Every opened handle is a simulated device with two
+ * bounded FIFOs:
+ *
+ *   host -> FT_Write -> [tx FIFO] -> drained at txBytesPerSec
+ *                                     (looped back into rx, or discarded)
+ *   device pattern generator at rxBytesPerSec -> [rx FIFO] -> FT_Read
+ *
+ * Rates of 0 mean "unlimited" for the tx drain and "off" for the rx
+ * generator. Bytes that arrive at a full rx FIFO are dropped and counted,
+ * like a device overrun. FT_Read and FT_Write block up to the timeouts
+ * set with FT_SetTimeouts (0 = wait indefinitely), as the driver does.
+ *
+ * Defaults come from the environment when the first device is opened:
+ *   SCP_MOCK_FTDI_TX_RATE, SCP_MOCK_FTDI_RX_RATE   bytes/s
+ *   SCP_MOCK_FTDI_TX_BUFFER, SCP_MOCK_FTDI_RX_BUFFER  bytes
+ *   SCP_MOCK_FTDI_LOOPBACK                          0 or 1
+ */
+
+struct scpMockFtdiConfig {
+    double txBytesPerSec = 0.0;       // Device drain rate; 0 = unlimited
+    double rxBytesPerSec = 0.0;       // Pattern generator rate; 0 = off
+    size_t txBufferBytes = 64 * 1024;
+    size_t rxBufferBytes = 64 * 1024;
+    bool loopback = true;             // Drained tx bytes reappear in rx
+};
+
+struct scpMockFtdiStats {
+    uint64_t bytesWritten = 0;        // Accepted by FT_Write
+    uint64_t bytesRead = 0;           // Returned by FT_Read
+    uint64_t bytesDrained = 0;        // Consumed by the simulated device
+    uint64_t rxOverflowBytes = 0;     // Dropped at a full rx FIFO
+    uint64_t writeTimeouts = 0;       // FT_Write calls that returned short
+    uint64_t readCalls = 0;
+    uint64_t writeCalls = 0;
+};
+
+// Configuration for devices opened after this call (overrides the environment)
+void scpMockFtdiSetConfig(const scpMockFtdiConfig& config);
+scpMockFtdiConfig scpMockFtdiGetConfig();
+
+// Push bytes into a device's rx FIFO as if the hardware had sent them
+size_t scpMockFtdiInject(FT_HANDLE handle, const void* data, size_t length);
+
+// Statistics of one open device, and totals over every device opened so far
+scpMockFtdiStats scpMockFtdiGetStats(FT_HANDLE handle);
+scpMockFtdiStats scpMockFtdiTotals();
+void scpMockFtdiResetTotals();
+
+#endif // FTD2XX_MOCK_H
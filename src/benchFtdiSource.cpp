@@ -0,0 +1,90 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+#include <chrono>
+#include <thread>
+#include "scpFtdiSource.h"
+#include "ftd2xx_mock.h"
+
+/**
+ * @brief Throughput benchmark for scpFtdiSource against the mock D2XX library
+ *
+ * The simulated device drains FT_Write at --tx-rate and loops the bytes
+ * back into its receive FIFO, so one run measures the generator/writer
+ * pipeline (underruns, write rate) and the FT_Read ingest path (read
+ * rate, rx overflow) together. With --rx-rate the device additionally
+ * streams a counter pattern of its own.
+ */
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    double durationSec = 2.0;
+    scpMockFtdiConfig config;
+    config.txBytesPerSec = 8.0e6;   // Roughly an FT232H in synchronous FIFO mode
+    size_t bufferSize = 4096;
+    size_t depth = 3;
+
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--duration" && i + 1 < args.size()) {
+            durationSec = args[++i].toDouble();
+        } else if (args[i] == "--tx-rate" && i + 1 < args.size()) {
+            config.txBytesPerSec = args[++i].toDouble();
+        } else if (args[i] == "--rx-rate" && i + 1 < args.size()) {
+            config.rxBytesPerSec = args[++i].toDouble();
+        } else if (args[i] == "--fifo" && i + 1 < args.size()) {
+            config.txBufferBytes = config.rxBufferBytes = args[++i].toULongLong();
+        } else if (args[i] == "--buffer" && i + 1 < args.size()) {
+            bufferSize = args[++i].toULongLong();
+        } else if (args[i] == "--depth" && i + 1 < args.size()) {
+            depth = args[++i].toULongLong();
+        } else if (args[i] == "--no-loopback") {
+            config.loopback = false;
+        } else if (args[i] == "--help" || args[i] == "-h") {
+            qDebug() << "Usage:" << args[0] << "[options]";
+            qDebug() << "Options:";
+            qDebug() << "  --duration <s>    Run time (default: 2)";
+            qDebug() << "  --tx-rate <B/s>   Device drain rate, 0 = unlimited (default: 8e6)";
+            qDebug() << "  --rx-rate <B/s>   Device pattern stream rate, 0 = off (default: 0)";
+            qDebug() << "  --fifo <bytes>    Device tx/rx FIFO size (default: 65536)";
+            qDebug() << "  --buffer <bytes>  scpFtdiSource buffer size (default: 4096)";
+            qDebug() << "  --depth <n>       Pipeline buffers, 2-4 (default: 3)";
+            qDebug() << "  --no-loopback     Discard written bytes instead of echoing them";
+            return 0;
+        }
+    }
+
+    scpMockFtdiSetConfig(config);
+    scpMockFtdiResetTotals();
+
+    scpFtdiSource source("MOCK0001", bufferSize);
+    source.setPipelineDepth(depth);
+    if (!source.start()) {
+        qCritical() << "Failed to start scpFtdiSource on the mock device";
+        return 1;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(durationSec));
+    QVector<float> recent;
+    const int got = source.copyRecentSamples(1024, recent);
+    source.stop();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    const scpMockFtdiStats totals = scpMockFtdiTotals();
+    qDebug().noquote() << QString("tx rate %1 MB/s, buffer %2 x %3, %4 s")
+                          .arg(config.txBytesPerSec / 1e6, 0, 'f', 2).arg(depth).arg(bufferSize)
+                          .arg(elapsed, 0, 'f', 2);
+    qDebug().noquote() << QString("  written   %1 MB/s  (%2 bytes, %3 FT_Write calls, %4 short)")
+                          .arg(totals.bytesWritten / elapsed / 1e6, 0, 'f', 2).arg(totals.bytesWritten)
+                          .arg(totals.writeCalls).arg(totals.writeTimeouts);
+    qDebug().noquote() << QString("  read      %1 MB/s  (%2 bytes, %3 FT_Read calls)")
+                          .arg(source.bytesRead() / elapsed / 1e6, 0, 'f', 2).arg(source.bytesRead())
+                          .arg(totals.readCalls);
+    qDebug().noquote() << QString("  underruns %1, write errors %2, read errors %3, rx overflow %4 bytes")
+                          .arg(source.underruns()).arg(source.writeErrors()).arg(source.readErrors())
+                          .arg(totals.rxOverflowBytes);
+    qDebug().noquote() << QString("  copyRecentSamples returned %1 samples").arg(got);
+    return 0;
+}
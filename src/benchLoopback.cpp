@@ -0,0 +1,312 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDir>
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "scpUsbReadController.h"
+#include "scpUsbWriteController.h"
+
+/**
+ * @brief End-to-end loopback benchmark for the USB read/write controllers
+ *
+ * scpUsbWriteController writes into a FIFO that scpUsbReadController
+ * (threaded reader) reads back. Each packet carries a sequence number and
+ * its enqueue timestamp, so the receiving side measures latency and lost
+ * packets. Every combination of the swept parameters runs for a fixed
+ * duration and prints one result row.
+ */
+class LoopbackBench : public QObject {
+    Q_OBJECT
+
+public:
+    struct Config {
+        int readBytes;
+        int writeBytes;
+        double readFreq;
+        double writeFreq;
+    };
+
+    LoopbackBench(const QString& fifoPath, const QVector<Config>& configs,
+                  double durationSec, double offerFactor, QObject* parent = nullptr)
+        : QObject(parent)
+        , m_fifoPath(fifoPath)
+        , m_configs(configs)
+        , m_durationMs(static_cast<int>(durationSec * 1000.0))
+        , m_offerFactor(offerFactor)
+    {
+        m_producerTimer.setTimerType(Qt::PreciseTimer);
+        connect(&m_producerTimer, &QTimer::timeout, this, &LoopbackBench::produce);
+        connect(&m_loadTimer, &QTimer::timeout, this, [this]() {
+            QElapsedTimer busy;
+            busy.start();
+            while (busy.elapsed() < m_mainLoadMs) {
+            }
+        });
+    }
+
+    // Bytes per dataReceived block on the read side; 0 = one signal per read
+    void setReadBatch(int bytes) { m_readBatch = bytes; }
+    // Reader and writer on their own I/O threads
+    void setIoThreads(bool enable) { m_ioThreads = enable; }
+    // Busy the main thread this long every 16 ms, like a heavy repaint
+    void setMainLoad(int ms) { m_mainLoadMs = ms; }
+
+    void start() {
+        qDebug().noquote() << QString("%1 %2 %3 %4 | %5 %6 | %7 %8 %9 %10 | %11 %12")
+            .arg("rdBytes", 8).arg("wrBytes", 8).arg("rdHz", 7).arg("wrHz", 7)
+            .arg("offerMB/s", 10).arg("gotMB/s", 9)
+            .arg("p50ms", 8).arg("p90ms", 8).arg("p99ms", 8).arg("maxms", 8)
+            .arg("lost", 7).arg("dropped", 8);
+        runNext();
+    }
+
+private slots:
+    void produce() {
+        // Queue as many packets as the offered rate calls for by now
+        const qint64 due = static_cast<qint64>(m_clock.nsecsElapsed() / 1e9 * m_offeredRate / m_packetSize);
+        while (m_nextSeq < due) {
+            QByteArray packet(m_packetSize, '\0');
+            uchar* p = reinterpret_cast<uchar*>(packet.data());
+            qToLittleEndian<qint64>(m_nextSeq, p);
+            qToLittleEndian<qint64>(m_clock.nsecsElapsed(), p + 8);
+            m_writer->queueData(packet);
+            ++m_nextSeq;
+        }
+    }
+
+    void onDataReceived(const QByteArray& data) {
+        const qint64 now = m_clock.nsecsElapsed();
+        m_rx.append(data);
+        m_receivedBytes += data.size();
+
+        int offset = 0;
+        while (m_rx.size() - offset >= m_packetSize) {
+            const uchar* p = reinterpret_cast<const uchar*>(m_rx.constData() + offset);
+            const qint64 seq = qFromLittleEndian<qint64>(p);
+            const qint64 sentNs = qFromLittleEndian<qint64>(p + 8);
+            if (seq > m_expectedSeq) m_lostPackets += seq - m_expectedSeq;
+            m_expectedSeq = seq + 1;
+            m_latenciesNs.push_back(now - sentNs);
+            offset += m_packetSize;
+        }
+        m_rx.remove(0, offset);
+    }
+
+private:
+    void runNext() {
+        if (m_index >= m_configs.size()) {
+            ::unlink(m_fifoPath.toLocal8Bit().constData());
+            QCoreApplication::quit();
+            return;
+        }
+        const Config& cfg = m_configs[m_index];
+
+        ::unlink(m_fifoPath.toLocal8Bit().constData());
+        if (::mkfifo(m_fifoPath.toLocal8Bit().constData(), 0600) != 0) {
+            qDebug() << "Failed to create FIFO" << m_fifoPath;
+            QCoreApplication::exit(1);
+            return;
+        }
+        // Holding a non-blocking read end lets the writer open without waiting;
+        // also the place to enlarge the pipe buffer
+        m_holdFd = ::open(m_fifoPath.toLocal8Bit().constData(), O_RDONLY | O_NONBLOCK);
+#ifdef F_SETPIPE_SZ
+        fcntl(m_holdFd, F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+        m_writer = new scpUsbWriteController(this);
+        if (m_ioThreads) m_writer->startIoThread();
+        m_writer->setAutoReconnect(false);
+        m_writer->setDevicePath(m_fifoPath);
+        m_writer->setBytesPerWrite(cfg.writeBytes);
+        m_writer->setOutputFrequency(cfg.writeFreq);
+
+        m_reader = new scpUsbReadController(this);
+        if (m_ioThreads) m_reader->startIoThread();
+        m_reader->setAutoReconnect(false);
+        m_reader->setDevicePath(m_fifoPath);
+        m_reader->setBytesPerRead(cfg.readBytes);
+        m_reader->setSamplingFrequency(cfg.readFreq);
+        m_reader->setReadMode(scpFTDIReader::ThreadedMode);
+        m_reader->setTargetThroughput(cfg.readFreq * cfg.readBytes);
+        m_reader->setBatchSize(m_readBatch);
+        connect(m_reader, &scpUsbReadController::dataReceived,
+                this, &LoopbackBench::onDataReceived);
+
+        if (!m_writer->open() || !m_reader->open()) {
+            qDebug() << "Failed to open loopback FIFO";
+            QCoreApplication::exit(1);
+            return;
+        }
+
+        m_packetSize = std::max(16, cfg.writeBytes);
+        m_offeredRate = cfg.writeFreq * cfg.writeBytes * m_offerFactor;
+        m_nextSeq = 0;
+        m_expectedSeq = 0;
+        m_lostPackets = 0;
+        m_receivedBytes = 0;
+        m_rx.clear();
+        m_latenciesNs.clear();
+
+        m_clock.start();
+        m_reader->start();
+        m_writer->start();
+        m_producerTimer.start(1);
+        if (m_mainLoadMs > 0) m_loadTimer.start(16);
+
+        QTimer::singleShot(m_durationMs, this, &LoopbackBench::finishRun);
+    }
+
+    void finishRun() {
+        const double seconds = m_clock.nsecsElapsed() / 1e9;
+        const qint64 receivedInWindow = m_receivedBytes;
+        const qint64 dropped = m_writer->droppedPackets();
+
+        // Closing the write end gives the blocked reader EOF so it can stop
+        m_producerTimer.stop();
+        m_loadTimer.stop();
+        disconnect(m_reader, nullptr, this, nullptr);
+        m_writer->close();
+        m_reader->close();
+        ::close(m_holdFd);
+        m_holdFd = -1;
+
+        report(m_configs[m_index], receivedInWindow / seconds, dropped);
+
+        m_writer->deleteLater();
+        m_reader->deleteLater();
+        m_writer = nullptr;
+        m_reader = nullptr;
+        ++m_index;
+        QTimer::singleShot(0, this, &LoopbackBench::runNext);
+    }
+
+    void report(const Config& cfg, double bytesPerSec, qint64 dropped) {
+        std::sort(m_latenciesNs.begin(), m_latenciesNs.end());
+        auto pct = [this](double q) -> double {
+            if (m_latenciesNs.empty()) return 0.0;
+            const size_t i = std::min(m_latenciesNs.size() - 1,
+                                      static_cast<size_t>(q * m_latenciesNs.size()));
+            return m_latenciesNs[i] / 1e6;
+        };
+
+        qDebug().noquote() << QString("%1 %2 %3 %4 | %5 %6 | %7 %8 %9 %10 | %11 %12")
+            .arg(cfg.readBytes, 8).arg(cfg.writeBytes, 8)
+            .arg(cfg.readFreq, 7, 'f', 0).arg(cfg.writeFreq, 7, 'f', 0)
+            .arg(m_offeredRate / 1e6, 10, 'f', 3).arg(bytesPerSec / 1e6, 9, 'f', 3)
+            .arg(pct(0.50), 8, 'f', 2).arg(pct(0.90), 8, 'f', 2)
+            .arg(pct(0.99), 8, 'f', 2).arg(pct(1.0), 8, 'f', 2)
+            .arg(m_lostPackets, 7).arg(dropped, 8);
+    }
+
+    QString m_fifoPath;
+    QVector<Config> m_configs;
+    int m_index = 0;
+    int m_durationMs;
+    double m_offerFactor;
+    int m_readBatch = 0;
+    bool m_ioThreads = false;
+    int m_mainLoadMs = 0;
+
+    scpUsbWriteController* m_writer = nullptr;
+    scpUsbReadController* m_reader = nullptr;
+    int m_holdFd = -1;
+    QTimer m_producerTimer;
+    QTimer m_loadTimer;
+    QElapsedTimer m_clock;      // Run clock and timestamp base shared by both ends
+
+    int m_packetSize = 16;
+    double m_offeredRate = 0.0;
+    qint64 m_nextSeq = 0;
+    qint64 m_expectedSeq = 0;
+    qint64 m_lostPackets = 0;
+    qint64 m_receivedBytes = 0;
+    QByteArray m_rx;
+    std::vector<qint64> m_latenciesNs;
+};
+
+static QVector<double> parseList(const QString& text) {
+    QVector<double> values;
+    for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+        values.append(part.toDouble());
+    }
+    return values;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QVector<double> readBytes = {256, 4096};
+    QVector<double> writeBytes = {128, 1024};
+    QVector<double> readFreqs = {1000};
+    QVector<double> writeFreqs = {500, 1000};
+    double duration = 2.0;
+    double offer = 1.0;
+    int readBatch = 0;
+    bool ioThreads = false;
+    int mainLoad = 0;
+    QString fifoPath = QDir::temp().filePath(QString("scp_loopback_%1").arg(QCoreApplication::applicationPid()));
+
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--read-bytes" && i + 1 < args.size()) {
+            readBytes = parseList(args[++i]);
+        } else if (args[i] == "--write-bytes" && i + 1 < args.size()) {
+            writeBytes = parseList(args[++i]);
+        } else if (args[i] == "--read-freq" && i + 1 < args.size()) {
+            readFreqs = parseList(args[++i]);
+        } else if (args[i] == "--write-freq" && i + 1 < args.size()) {
+            writeFreqs = parseList(args[++i]);
+        } else if (args[i] == "--duration" && i + 1 < args.size()) {
+            duration = args[++i].toDouble();
+        } else if (args[i] == "--offer" && i + 1 < args.size()) {
+            offer = args[++i].toDouble();
+        } else if (args[i] == "--batch" && i + 1 < args.size()) {
+            readBatch = args[++i].toInt();
+        } else if (args[i] == "--io-thread") {
+            ioThreads = true;
+        } else if (args[i] == "--load" && i + 1 < args.size()) {
+            mainLoad = args[++i].toInt();
+        } else if (args[i] == "--fifo" && i + 1 < args.size()) {
+            fifoPath = args[++i];
+        } else if (args[i] == "--help" || args[i] == "-h") {
+            qDebug() << "Usage:" << args[0] << "[options]";
+            qDebug() << "Lists are comma separated; every combination is run.";
+            qDebug() << "Options:";
+            qDebug() << "  --read-bytes <list>   Bytes per read (default: 256,4096)";
+            qDebug() << "  --write-bytes <list>  Bytes per write, also the packet size (default: 128,1024)";
+            qDebug() << "  --read-freq <list>    Read frequency in Hz (default: 1000)";
+            qDebug() << "  --write-freq <list>   Write frequency in Hz (default: 500,1000)";
+            qDebug() << "  --duration <s>        Seconds per configuration (default: 2)";
+            qDebug() << "  --offer <factor>      Offered load relative to the write rate (default: 1.0)";
+            qDebug() << "  --batch <bytes>       Batch reads into blocks of this size (default: 0 = off)";
+            qDebug() << "  --io-thread           Run reader and writer on their own I/O threads";
+            qDebug() << "  --load <ms>           Busy the main thread this long every 16 ms";
+            qDebug() << "  --fifo <path>         FIFO to create for the loopback";
+            return 0;
+        }
+    }
+
+    QVector<LoopbackBench::Config> configs;
+    for (double rb : readBytes)
+        for (double wb : writeBytes)
+            for (double rf : readFreqs)
+                for (double wf : writeFreqs)
+                    configs.append({static_cast<int>(rb), static_cast<int>(wb), rf, wf});
+
+    LoopbackBench bench(fifoPath, configs, duration, offer);
+    bench.setReadBatch(readBatch);
+    bench.setIoThreads(ioThreads);
+    bench.setMainLoad(mainLoad);
+    QTimer::singleShot(0, &bench, &LoopbackBench::start);
+
+    return app.exec();
+}
+
+#include "benchLoopback.moc"
@@ -1,4 +1,5 @@
 #include <memory>
+#include <algorithm>
 #include <QCoreApplication>
 #include <QApplication>
 #include <QCommandLineParser>
@@ -10,12 +11,17 @@
 #include "scpViewTerminal.h"
 #include "scpAudioInputSource.h"
 #include "scpSignalGeneratorSource.h"
-#ifdef Q_OS_WIN
+#ifdef SCP_HAVE_FTDI
 #include "scpFtdiSource.h"
 #endif
 #include "scpMessageWaveSource.h"
 #include "scpSimulatedAcquisitionSource.h"
 #include "scpSimulatedGeneratorSource.h"
+#include "scpByteStreamSource.h"
+#include "scpUsbReadController.h"
+#include "scpMetricsExporter.h"
+#include "scpThroughputMonitor.h"
+#include "scpTrace.h"
 
 static bool wantsTerminal(int argc, char* argv[]) {
     for (int i = 0; i < argc; ++i) {
@@ -30,6 +36,20 @@ static bool wantsTerminal(int argc, char* argv[]) {
     return false;
 }
 
+// Runs the event loop, then writes the Chrome trace if one was asked for
+static int execAndDumpTrace(QCoreApplication& app, const QString& tracePath) {
+    const int rc = app.exec();
+    if (!tracePath.isEmpty()) {
+        QString error;
+        if (scpTracer::writeChromeTrace(tracePath, &error)) {
+            qInfo() << "Trace written to" << tracePath;
+        } else {
+            qWarning() << error;
+        }
+    }
+    return rc;
+}
+
 int main(int argc, char *argv[]) {
     bool terminal = wantsTerminal(argc, argv);
 
@@ -53,14 +73,14 @@ int main(int argc, char *argv[]) {
     QCommandLineOption viewOpt(QStringList() << "view", "View: gui | terminal", "view", terminal ? "terminal" : "gui");
     QCommandLineOption cliOpt(QStringList() << "cli" << "c", "Use CLI/terminal view (alias for --view=terminal)");
     QCommandLineOption uiOpt(QStringList() << "ui" << "u", "Use GUI view (alias for --view=gui)");
-    QString sourceHelp = "Source: audio | gen | msg | simacq | simgen";
-#ifdef Q_OS_WIN
+    QString sourceHelp = "Source: audio | gen | msg | simacq | simgen | bytes";
+#ifdef SCP_HAVE_FTDI
     sourceHelp += " | ftdi";
 #endif
     QCommandLineOption sourceOpt(QStringList() << "s" << "source", 
                                  sourceHelp, 
                                  "source", "simacq");
-#ifdef Q_OS_WIN
+#ifdef SCP_HAVE_FTDI
     QCommandLineOption ftdiOpt(QStringList() << "ftdi", "FTDI serial number (for --source=ftdi)", "serial");
 #endif
     QCommandLineOption startOpt(QStringList() << "S" << "start", "Start acquisition immediately");
@@ -69,12 +89,24 @@ int main(int argc, char *argv[]) {
     QCommandLineOption genFreqOpt(QStringList() << "f" << "gen-freq", "Generator frequency (Hz)", "hz");
     QCommandLineOption sizeOpt(QStringList() << "size", "Initial window size WxH (e.g. 1200x700)", "wxh");
     QCommandLineOption msgOpt(QStringList() << "msg", "Message text (for message source or display)", "text");
+    QCommandLineOption deviceOpt(QStringList() << "device", "Device or capture file (for --source=bytes)", "path");
+    QCommandLineOption formatOpt(QStringList() << "format", "Byte format: u8 | s16le | s16be | p12 (for --source=bytes)", "fmt", "u8");
+    QCommandLineOption channelsOpt(QStringList() << "channels", "Interleaved channels in the byte stream", "n", "1");
+    QCommandLineOption channelOpt(QStringList() << "channel", "Channel to display (0-based)", "idx", "0");
+    QCommandLineOption rateOpt(QStringList() << "rate", "Per-channel sample rate of the byte stream (Hz)", "hz", "10000");
+    QCommandLineOption baudOpt(QStringList() << "baud", "Read --device as a serial tty at this baud rate (Linux)", "baud");
+    QCommandLineOption ioThreadOpt(QStringList() << "io-thread", "Service the byte-stream reader on its own thread");
+    QCommandLineOption ioCpuOpt(QStringList() << "io-cpu", "Pin the reader's I/O threads to this CPU (implies --io-thread)", "cpu");
+    QCommandLineOption ioRtOpt(QStringList() << "io-rt", "Realtime priority 1-99 for the reader's I/O threads (implies --io-thread)", "prio");
+    QCommandLineOption metricsPortOpt(QStringList() << "metrics-port", "Serve Prometheus metrics on http://127.0.0.1:<port>/metrics", "port");
+    QCommandLineOption traceOpt(QStringList() << "trace", "Write a Chrome trace (chrome://tracing, Perfetto) of the pipeline to this file on exit", "file");
+    QCommandLineOption metricsSocketOpt(QStringList() << "metrics-socket", "Serve Prometheus metrics on this local socket", "name");
 
     parser.addOption(viewOpt);
     parser.addOption(cliOpt);
     parser.addOption(uiOpt);
     parser.addOption(sourceOpt);
-#ifdef Q_OS_WIN
+#ifdef SCP_HAVE_FTDI
     parser.addOption(ftdiOpt);
 #endif
     parser.addOption(startOpt);
@@ -83,6 +115,18 @@ int main(int argc, char *argv[]) {
     parser.addOption(genFreqOpt);
     parser.addOption(sizeOpt);
     parser.addOption(msgOpt);
+    parser.addOption(deviceOpt);
+    parser.addOption(formatOpt);
+    parser.addOption(channelsOpt);
+    parser.addOption(channelOpt);
+    parser.addOption(rateOpt);
+    parser.addOption(baudOpt);
+    parser.addOption(ioThreadOpt);
+    parser.addOption(ioCpuOpt);
+    parser.addOption(ioRtOpt);
+    parser.addOption(metricsPortOpt);
+    parser.addOption(metricsSocketOpt);
+    parser.addOption(traceOpt);
     parser.process(app);
 
     // Determine final view mode
@@ -104,15 +148,21 @@ int main(int argc, char *argv[]) {
     const QString sourceStr = parser.value(sourceOpt).toLower();
     const QString msg = parser.value(msgOpt);
 
+    // One monitor for the whole app: sources count samples and drops, the reader
+    // bytes and lost frames, and whichever view is shown the sensor-to-pixel latency.
+    // Declared first so it outlives every source thread that records into it.
+    scpThroughputMonitor monitor;
+
     // instantiate common sources
     scpAudioInputSource audio;
     scpSignalGeneratorSource gen;
     scpMessageWaveSource msgSource(msg.toStdString(), 1000, 20); // default 1000Hz sample, 20ms/char
-#ifdef Q_OS_WIN
+#ifdef SCP_HAVE_FTDI
     std::unique_ptr<scpFtdiSource> ftdi;
 #endif
     std::unique_ptr<scpSimulatedAcquisitionSource> simAcq;
     std::unique_ptr<scpSimulatedGeneratorSource> simGen;
+    std::unique_ptr<scpByteStreamSource> bytesSrc;
 
     scpDataSource* src = nullptr; // default
 
@@ -124,7 +174,7 @@ int main(int argc, char *argv[]) {
     } else if (sourceStr == "simacq") {
         simAcq = std::make_unique<scpSimulatedAcquisitionSource>();
         src = simAcq.get();
-#ifdef Q_OS_WIN
+#ifdef SCP_HAVE_FTDI
     } else if (sourceStr == "ftdi") {
         QString serial = parser.value(ftdiOpt);
         if (serial.isEmpty()) {
@@ -134,6 +184,46 @@ int main(int argc, char *argv[]) {
         ftdi = std::make_unique<scpFtdiSource>(serial.toStdString(), 256);
         src = ftdi.get();
 #endif
+    } else if (sourceStr == "bytes") {
+        const QString device = parser.value(deviceOpt);
+        if (device.isEmpty()) {
+            qCritical() << "Device path required with --source=bytes";
+            return 1;
+        }
+        bool ok = false;
+        auto format = scpByteStreamSource::sampleFormatFromString(parser.value(formatOpt), &ok);
+        if (!ok) {
+            qCritical() << "Unknown byte format:" << parser.value(formatOpt);
+            return 1;
+        }
+        bytesSrc = std::make_unique<scpByteStreamSource>();
+        bytesSrc->setDevicePath(device);
+        bytesSrc->setSampleFormat(format);
+        bytesSrc->setChannelCount(parser.value(channelsOpt).toInt());
+        bytesSrc->setChannel(parser.value(channelOpt).toInt());
+        if (parser.isSet(baudOpt)) {
+            if (!bytesSrc->setSerialDevice(device, parser.value(baudOpt).toInt())) {
+                qCritical() << "Serial devices are not supported on this platform";
+                return 1;
+            }
+            // Sample rate follows the line rate unless given explicitly
+            if (parser.isSet(rateOpt)) bytesSrc->setSampleRate(std::max(1, parser.value(rateOpt).toInt()));
+        } else {
+            bytesSrc->setSampleRate(std::max(1, parser.value(rateOpt).toInt()));
+            // Threaded reads paced at the stream's real byte rate; capture files replay in a loop
+            scpUsbReadController* reader = bytesSrc->controller();
+            reader->setTargetThroughput(bytesSrc->sampleRate() * bytesSrc->bytesPerFrame());
+            reader->setReadMode(scpFTDIReader::ThreadedMode);
+            reader->setMemoryMappedReplay(true);
+            reader->setLoopReplay(true);
+            if (parser.isSet(ioThreadOpt) || parser.isSet(ioCpuOpt) || parser.isSet(ioRtOpt)) {
+                scpThreadTuning tuning;
+                if (parser.isSet(ioCpuOpt)) tuning.cpu = parser.value(ioCpuOpt).toInt();
+                if (parser.isSet(ioRtOpt)) tuning.realtimePriority = parser.value(ioRtOpt).toInt();
+                reader->startIoThread(tuning);
+            }
+        }
+        src = bytesSrc.get();
     } else if (sourceStr == "msg") {
         // update message if provided
         if (!msg.isEmpty()) msgSource.setMessage(msg.toStdString());
@@ -146,6 +236,34 @@ int main(int argc, char *argv[]) {
         src = simAcq.get();
     }
 
+    // Metrics endpoint; views register their collectors below
+    scpMetricsExporter metrics;
+    if (parser.isSet(metricsPortOpt)) {
+        bool ok = false;
+        const int port = parser.value(metricsPortOpt).toInt(&ok);
+        if (!ok || port <= 0 || port > 65535 || !metrics.listenTcp(static_cast<quint16>(port))) {
+            qCritical() << "Cannot serve metrics on port" << parser.value(metricsPortOpt);
+            return 1;
+        }
+    }
+    if (parser.isSet(metricsSocketOpt) && !metrics.listenLocal(parser.value(metricsSocketOpt))) {
+        qCritical() << "Cannot serve metrics on socket" << parser.value(metricsSocketOpt);
+        return 1;
+    }
+    monitor.start();
+    metrics.addMonitor("app", &monitor);
+    src->setThroughputMonitor(&monitor);
+    if (bytesSrc) {
+        bytesSrc->controller()->setThroughputMonitor(&monitor);
+        metrics.addReadController(sourceStr, bytesSrc->controller());
+    }
+
+    const QString tracePath = parser.value(traceOpt);
+    if (!tracePath.isEmpty() && !scpTracer::compiledIn()) {
+        qWarning() << "--trace ignored: tracing is not compiled in (configure with -DSCP_WITH_TRACING=ON)";
+    }
+    SCP_TRACE_THREAD_NAME("main");
+
     const bool doStart = parser.isSet(startOpt);
     if (doStart) src->start();
 
@@ -155,6 +273,15 @@ int main(int argc, char *argv[]) {
         term.setSource(src);
         term.setTotalTimeWindowSec(0.5);
         term.setVerticalScale(1.0f);
+        term.setThroughputMonitor(&monitor);
+        metrics.addCollector("terminal", [&term](scpMetricsExporter::Writer& out, const QString& p) {
+            out.gauge("scope_view_frame_interval_seconds", "Current redraw interval of the view",
+                      term.frameIntervalMs() / 1000.0, p);
+            out.gauge("scope_view_frame_write_seconds", "Smoothed time to write one frame",
+                      term.frameWriteMs() / 1000.0, p);
+            out.gauge("scope_view_output_bytes_per_second", "Frame output rate of the view",
+                      term.outputBytesPerSecond(), p);
+        });
         
         // Set up sources for combined mode
         // Create both sources if not already created
@@ -166,6 +293,8 @@ int main(int argc, char *argv[]) {
         }
         
         // Set up combined mode sources
+        simAcq->setThroughputMonitor(&monitor);
+        simGen->setThroughputMonitor(&monitor);
         term.setAcquisitionSource(simAcq.get());
         term.setGeneratorSource(simGen.get());
 
@@ -198,12 +327,17 @@ int main(int argc, char *argv[]) {
             term.start();
         }
         // Otherwise, wait for user to type "scope start" command
-        return app.exec();
+        return execAndDumpTrace(app, tracePath);
     }
 
     // GUI mode
     scpMainWindow win;
     win.show();
+    win.setThroughputMonitor(&monitor);
+    metrics.addCollector("gui", [&win](scpMetricsExporter::Writer& out, const QString& p) {
+        out.histogram("scope_view_frame_seconds", "Time spent painting one frame",
+                      win.scopeView()->frameTimes().snapshot(), p);
+    });
 
     // give GUI the selected source
     win.setSource(src);
@@ -228,5 +362,5 @@ int main(int argc, char *argv[]) {
         }
     });
 
-    return app.exec();
+    return execAndDumpTrace(app, tracePath);
 }
@@ -83,9 +83,11 @@ int scpAudioInputSource::copyRecentSamples(int count, QVector<float>& out) {
 
 void scpAudioInputSource::onReadyRead() {
     if (!m_device) return;
+    const qint64 producedNs = scpMonotonicNs();
     QByteArray data = m_device->readAll();
     if (data.isEmpty()) return;
     appendSamplesFromBytes(data.constData(), data.size());
+    stampSamples(producedNs, data.size() / qMax(1, m_format.bytesPerFrame()));
 }
 
 void scpAudioInputSource::appendSamplesFromBytes(const char* data, int bytes) {
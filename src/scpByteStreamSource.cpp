@@ -0,0 +1,325 @@
+#include "scpByteStreamSource.h"
+#include "scpUsbReadController.h"
+#ifdef SCP_HAVE_SERIAL
+#include "scpSerialInterface.h"
+#endif
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+// Bytes per encoding unit and samples it holds (Packed12 stores two samples in three bytes)
+static int unitBytes(scpByteStreamSource::SampleFormat format) {
+    switch (format) {
+        case scpByteStreamSource::UInt8: return 1;
+        case scpByteStreamSource::Int16LE:
+        case scpByteStreamSource::Int16BE: return 2;
+        case scpByteStreamSource::Packed12: return 3;
+    }
+    return 1;
+}
+
+static int unitSamples(scpByteStreamSource::SampleFormat format) {
+    return format == scpByteStreamSource::Packed12 ? 2 : 1;
+}
+
+// ----------------------------------------------------------------------------
+// Decode kernels: straight-line loops with no per-sample branches so the
+// compiler can vectorize the contiguous (single-channel) case.
+// ----------------------------------------------------------------------------
+
+static void decodeU8(const uchar* in, int first, int stride, int count, float* out) {
+    constexpr float kScale = 1.0f / 128.0f;
+    if (stride == 1) {
+        in += first;
+        for (int k = 0; k < count; ++k) out[k] = (static_cast<float>(in[k]) - 128.0f) * kScale;
+        return;
+    }
+    for (int k = 0; k < count; ++k) {
+        out[k] = (static_cast<float>(in[first + k * stride]) - 128.0f) * kScale;
+    }
+}
+
+static void decodeS16LE(const uchar* in, int first, int stride, int count, float* out) {
+    constexpr float kScale = 1.0f / 32768.0f;
+    for (int k = 0; k < count; ++k) {
+        out[k] = static_cast<float>(qFromLittleEndian<qint16>(in + 2 * (first + k * stride))) * kScale;
+    }
+}
+
+static void decodeS16BE(const uchar* in, int first, int stride, int count, float* out) {
+    constexpr float kScale = 1.0f / 32768.0f;
+    for (int k = 0; k < count; ++k) {
+        out[k] = static_cast<float>(qFromBigEndian<qint16>(in + 2 * (first + k * stride))) * kScale;
+    }
+}
+
+static inline int packed12At(const uchar* in, int sample) {
+    // Pair p occupies bytes 3p..3p+2: s0 = b0 | (b1 & 0x0F) << 8, s1 = (b1 >> 4) | b2 << 4
+    const uchar* p = in + 3 * (sample >> 1);
+    return (sample & 1) ? ((p[1] >> 4) | (p[2] << 4)) : (p[0] | ((p[1] & 0x0F) << 8));
+}
+
+static void decodeP12(const uchar* in, int first, int stride, int count, float* out) {
+    constexpr float kScale = 1.0f / 2048.0f;
+    if (stride == 1 && (first & 1) == 0) {
+        // Whole pairs at a time
+        const uchar* p = in + 3 * (first >> 1);
+        const int pairs = count / 2;
+        for (int k = 0; k < pairs; ++k) {
+            const int b0 = p[3 * k], b1 = p[3 * k + 1], b2 = p[3 * k + 2];
+            out[2 * k]     = static_cast<float>((b0 | ((b1 & 0x0F) << 8)) - 2048) * kScale;
+            out[2 * k + 1] = static_cast<float>(((b1 >> 4) | (b2 << 4)) - 2048) * kScale;
+        }
+        if (count & 1) {
+            out[count - 1] = static_cast<float>(packed12At(in, first + count - 1) - 2048) * kScale;
+        }
+        return;
+    }
+    for (int k = 0; k < count; ++k) {
+        out[k] = static_cast<float>(packed12At(in, first + k * stride) - 2048) * kScale;
+    }
+}
+
+scpByteStreamSource::scpByteStreamSource(QObject* parent)
+    : scpDataSource(parent),
+      m_controller(new scpUsbReadController(this)) {
+    // The ring only needs blocks at display rate, not one signal per read
+    m_controller->setBatchInterval(kBatchIntervalMs);
+    m_controller->setBatchSize(kBatchBytes);
+    connect(m_controller, &scpUsbReadController::dataReceived,
+            this, &scpByteStreamSource::onDataReceived);
+}
+
+scpByteStreamSource::~scpByteStreamSource() {
+    stop();
+}
+
+void scpByteStreamSource::setDevicePath(const QString& path) {
+    m_controller->setDevicePath(path);
+}
+
+void scpByteStreamSource::setChannelCount(int channels) {
+    m_channelCount = std::max(1, channels);
+    m_channel = std::clamp(m_channel, 0, m_channelCount - 1);
+}
+
+void scpByteStreamSource::setChannel(int channel) {
+    m_channel = std::clamp(channel, 0, m_channelCount - 1);
+}
+
+bool scpByteStreamSource::setSerialDevice(const QString& path, int baudRate) {
+#ifdef SCP_HAVE_SERIAL
+    if (!m_serial) {
+        m_serial = new scpSerialReader(this);
+        connect(m_serial, &scpSerialReader::dataReceived,
+                this, &scpByteStreamSource::onDataReceived);
+        connect(m_serial, &scpFTDIInterface::errorOccurred, this, [](const QString& error) {
+            qWarning() << "scpByteStreamSource: serial:" << error;
+        });
+    }
+    m_serial->setDevicePath(path);
+    m_serial->setBaudRate(baudRate);
+    return true;
+#else
+    Q_UNUSED(path);
+    Q_UNUSED(baudRate);
+    return false;
+#endif
+}
+
+double scpByteStreamSource::bytesPerFrame() const {
+    return static_cast<double>(unitBytes(m_format)) / unitSamples(m_format) * m_channelCount;
+}
+
+int scpByteStreamSource::sampleRate() const {
+    if (m_sampleRate > 0) return m_sampleRate;
+    // Derive from the reader: bytes/s delivered divided by bytes per frame
+#ifdef SCP_HAVE_SERIAL
+    if (m_serial) {
+        // 8N1: ten bit times per byte on the wire
+        return std::max(1, static_cast<int>(m_serial->baudRate() / 10.0 / bytesPerFrame()));
+    }
+#endif
+    double bytesPerSec = m_controller->targetThroughput();
+    if (bytesPerSec <= 0.0) {
+        bytesPerSec = m_controller->samplingFrequency() * m_controller->bytesPerRead();
+    }
+    return std::max(1, static_cast<int>(bytesPerSec / bytesPerFrame()));
+}
+
+bool scpByteStreamSource::start() {
+    if (m_running) return true;
+
+    {
+        QMutexLocker lock(&m_bufferMutex);
+        // Size the ring for ~1 s of the selected channel, within sane bounds
+        m_bufferSize = std::clamp(sampleRate() * kBufferSeconds, 1024, 16 * 1024 * 1024);
+        m_buffer.resize(m_bufferSize);
+        m_buffer.fill(0.0f);
+        m_bufferWritePos = 0;
+    }
+    m_remainder.clear();
+    m_sampleIndex = 0;
+
+#ifdef SCP_HAVE_SERIAL
+    if (m_serial) {
+        if (!m_serial->isOpen() && !m_serial->open()) return false;
+        m_serial->start();
+        if (!m_serial->isRunning()) {
+            qWarning() << "scpByteStreamSource: failed to start serial reader for" << m_serial->devicePath();
+            m_serial->close();
+            return false;
+        }
+        m_running = true;
+        emit stateChanged(true);
+        return true;
+    }
+#endif
+
+    m_controller->setBatchAlignment(unitBytes(m_format));
+    m_overflowBytesSeen = m_controller->batchOverflowBytes();
+    m_controller->start();
+    if (!m_controller->isRunning()) {
+        qWarning() << "scpByteStreamSource: failed to start reader for" << m_controller->devicePath();
+        m_controller->stop();
+        return false;
+    }
+
+    m_running = true;
+    emit stateChanged(true);
+    return true;
+}
+
+void scpByteStreamSource::stop() {
+    if (!m_running) return;
+#ifdef SCP_HAVE_SERIAL
+    if (m_serial) m_serial->close();
+#endif
+    m_controller->stop();
+    m_running = false;
+    emit stateChanged(false);
+}
+
+int scpByteStreamSource::copyRecentSamples(int count, QVector<float>& out) {
+    QMutexLocker lock(&m_bufferMutex);
+    int n = std::min(count, m_bufferSize);
+    out.resize(n);
+
+    if (n <= 0) return 0;
+
+    int end = m_bufferWritePos;
+    int start = (end - n + m_bufferSize) % m_bufferSize;
+
+    if (start < end) {
+        std::copy(m_buffer.begin() + start, m_buffer.begin() + end, out.begin());
+    } else {
+        int first = m_bufferSize - start;
+        std::copy(m_buffer.begin() + start, m_buffer.end(), out.begin());
+        std::copy(m_buffer.begin(), m_buffer.begin() + end, out.begin() + first);
+    }
+
+    return n;
+}
+
+void scpByteStreamSource::onDataReceived(const QByteArray& data) {
+    if (!m_running || data.isEmpty()) return;
+
+    // The reader's completion time; the serial backend delivers as soon as it reads
+    m_blockProducedNs = sender() == m_controller ? m_controller->deliveredReadNs() : scpMonotonicNs();
+
+    // Blocks the reader refused since the last delivery, in samples of the shown channel
+    const qint64 overflow = m_controller->batchOverflowBytes();
+    if (overflow > m_overflowBytesSeen) {
+        reportDropped(static_cast<int>((overflow - m_overflowBytesSeen) / bytesPerFrame()));
+        m_overflowBytesSeen = overflow;
+    }
+
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    int size = data.size();
+    const int unit = unitBytes(m_format);
+
+    // Complete an encoding unit split across the previous block first
+    if (!m_remainder.isEmpty()) {
+        const int need = std::min(unit - static_cast<int>(m_remainder.size()), size);
+        m_remainder.append(data.constData(), need);
+        bytes += need;
+        size -= need;
+        if (m_remainder.size() < unit) return;
+        decode(reinterpret_cast<const uchar*>(m_remainder.constData()), unit);
+        m_remainder.clear();
+    }
+
+    const int consumed = decode(bytes, size);
+    if (consumed < size) {
+        m_remainder.append(reinterpret_cast<const char*>(bytes) + consumed, size - consumed);
+    }
+}
+
+int scpByteStreamSource::decode(const uchar* data, int bytes) {
+    const int unit = unitBytes(m_format);
+    const int units = bytes / unit;
+    const int totalSamples = units * unitSamples(m_format);
+    if (totalSamples == 0) return 0;
+
+    // First sample of the selected channel in this block, then every channelCount-th
+    const int channels = m_channelCount;
+    const int phase = static_cast<int>(m_sampleIndex % channels);
+    const int first = (m_channel - phase + channels) % channels;
+    const int count = first < totalSamples ? (totalSamples - first + channels - 1) / channels : 0;
+    m_sampleIndex += totalSamples;
+
+    if (count > 0) {
+        if (m_decoded.size() < count) m_decoded.resize(count);
+        float* out = m_decoded.data();
+        switch (m_format) {
+            case UInt8:    decodeU8(data, first, channels, count, out); break;
+            case Int16LE:  decodeS16LE(data, first, channels, count, out); break;
+            case Int16BE:  decodeS16BE(data, first, channels, count, out); break;
+            case Packed12: decodeP12(data, first, channels, count, out); break;
+        }
+        appendToRing(out, count);
+        stampSamples(m_blockProducedNs, count);
+
+        // Emit signal for real-time updates
+        emit samplesReady(out, count);
+    }
+
+    return units * unit;
+}
+
+void scpByteStreamSource::appendToRing(const float* data, int count) {
+    QMutexLocker lock(&m_bufferMutex);
+    if (m_bufferSize <= 0) return;
+
+    // Only the newest bufferSize samples can survive
+    if (count > m_bufferSize) {
+        data += count - m_bufferSize;
+        count = m_bufferSize;
+    }
+    const int first = std::min(count, m_bufferSize - m_bufferWritePos);
+    std::memcpy(m_buffer.data() + m_bufferWritePos, data, first * sizeof(float));
+    std::memcpy(m_buffer.data(), data + first, (count - first) * sizeof(float));
+    m_bufferWritePos = (m_bufferWritePos + count) % m_bufferSize;
+}
+
+scpByteStreamSource::SampleFormat scpByteStreamSource::sampleFormatFromString(const QString& name, bool* ok) {
+    const QString lower = name.toLower().trimmed();
+    if (ok) *ok = true;
+    if (lower == "u8" || lower == "uint8") return UInt8;
+    if (lower == "s16le" || lower == "int16le" || lower == "s16") return Int16LE;
+    if (lower == "s16be" || lower == "int16be") return Int16BE;
+    if (lower == "p12" || lower == "packed12") return Packed12;
+    if (ok) *ok = false;
+    return UInt8;  // Default
+}
+
+QString scpByteStreamSource::sampleFormatToString(SampleFormat format) {
+    switch (format) {
+        case UInt8: return "u8";
+        case Int16LE: return "s16le";
+        case Int16BE: return "s16be";
+        case Packed12: return "p12";
+    }
+    return "unknown";
+}
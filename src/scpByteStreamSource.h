@@ -0,0 +1,100 @@
+#pragma once
+#include "scpDataSource.h"
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+class scpUsbReadController;
+class scpSerialReader;
+
+/**
+ * @brief Data source that decodes a raw FTDI/USB byte stream into samples
+ *
+ * Sits on top of scpUsbReadController, so it works with file-simulated
+ * devices as well as real ones on any platform. On Linux a tty can be
+ * read through scpSerialReader instead (see setSerialDevice()). Incoming blocks are
+ * decoded into floats in [-1, 1) and stored in a ring buffer.
+ *
+ * Supported encodings:
+ * - UInt8:    unsigned 8-bit, mid-scale 128
+ * - Int16LE:  signed 16-bit little-endian
+ * - Int16BE:  signed 16-bit big-endian
+ * - Packed12: unsigned 12-bit, two samples in three bytes, mid-scale 2048
+ *
+ * Multi-channel streams are interleaved sample by sample; the channel
+ * selected with setChannel() is the one exposed to the scope.
+ */
+class scpByteStreamSource : public scpDataSource {
+    Q_OBJECT
+public:
+    enum SampleFormat {
+        UInt8,
+        Int16LE,
+        Int16BE,
+        Packed12
+    };
+
+    explicit scpByteStreamSource(QObject* parent = nullptr);
+    ~scpByteStreamSource() override;
+
+    bool start() override;
+    void stop() override;
+    bool isActive() const override { return m_running; }
+    int sampleRate() const override;
+    int copyRecentSamples(int count, QVector<float>& out) override;
+
+    // Underlying reader (device path, read mode, rates)
+    scpUsbReadController* controller() const { return m_controller; }
+    void setDevicePath(const QString& path);
+    // Read a tty (/dev/ttyUSB*, /dev/ttyACM*) through the epoll serial backend
+    // instead of the file reader. Returns false where that backend is not built.
+    bool setSerialDevice(const QString& path, int baudRate);
+    bool isSerial() const { return m_serial != nullptr; }
+
+    // Stream layout (changes take effect on next start())
+    void setSampleFormat(SampleFormat format) { m_format = format; }
+    void setChannelCount(int channels);
+    void setChannel(int channel);
+    // Per-channel sample rate of the stream; 0 derives it from the reader rate
+    void setSampleRate(int hz) { m_sampleRate = hz; }
+
+    SampleFormat sampleFormat() const { return m_format; }
+    int channelCount() const { return m_channelCount; }
+    int channel() const { return m_channel; }
+    // Average bytes per interleaved frame (all channels)
+    double bytesPerFrame() const;
+
+    static SampleFormat sampleFormatFromString(const QString& name, bool* ok = nullptr);
+    static QString sampleFormatToString(SampleFormat format);
+
+private slots:
+    void onDataReceived(const QByteArray& data);
+
+private:
+    int decode(const uchar* data, int bytes);
+    void appendToRing(const float* data, int count);
+
+    scpUsbReadController* m_controller = nullptr;
+    scpSerialReader* m_serial = nullptr;
+    bool m_running = false;
+    SampleFormat m_format = UInt8;
+    int m_channelCount = 1;
+    int m_channel = 0;
+    int m_sampleRate = 0;
+
+    // Decoder state carried between blocks
+    QByteArray m_remainder;       // Bytes of an incomplete encoding unit
+    qint64 m_sampleIndex = 0;     // Position in the interleaved sample stream
+    QVector<float> m_decoded;     // Scratch for one block of decoded samples
+    qint64 m_blockProducedNs = 0; // Read time of the block being decoded
+    qint64 m_overflowBytesSeen = 0; // Reader batch overflow already reported as drops
+
+    mutable QMutex m_bufferMutex;
+    QVector<float> m_buffer;
+    int m_bufferSize = 0;
+    int m_bufferWritePos = 0;
+
+    static constexpr int kBufferSeconds = 1;  // ~1 second of data
+    static constexpr int kBatchBytes = 64 * 1024;  // Reads delivered per block, at most
+    static constexpr int kBatchIntervalMs = 5;     // ... or this often, well under a frame
+};
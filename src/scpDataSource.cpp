@@ -0,0 +1,21 @@
+#include "scpDataSource.h"
+#include "scpThroughputMonitor.h"
+#include <QDebug>
+
+void scpDataSource::setThroughputMonitor(scpThroughputMonitor* monitor) {
+    if (monitor == m_monitor) return;
+    if (isActive()) {
+        qWarning() << "scpDataSource: throughput monitor can only be set while stopped";
+        return;
+    }
+    m_monitor = monitor;
+}
+
+void scpDataSource::stampSamples(qint64 producedNs, int count) {
+    m_newestSampleNs.store(producedNs, std::memory_order_release);
+    if (m_monitor) m_monitor->recordSamples(count);
+}
+
+void scpDataSource::reportDropped(int count) {
+    if (m_monitor && count > 0) m_monitor->recordDropped(count);
+}
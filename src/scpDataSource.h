@@ -2,6 +2,10 @@
 #include <QObject>
 #include <QVector>
 #include <QMutex>
+#include <atomic>
+#include "scpLatencyHistogram.h"
+
+class scpThroughputMonitor;
 
 // Abstract base class for oscilloscope data sources
 class scpDataSource : public QObject {
@@ -18,9 +22,28 @@ public:
     // Copies up to 'count' most-recent samples into 'out'
     virtual int copyRecentSamples(int count, QVector<float>& out) = 0;
 
+    // When the newest stored sample was produced (scpMonotonicNs()), 0 before the first.
+    // Read it before copyRecentSamples(): the copy is then at least that fresh.
+    qint64 newestSampleTimeNs() const { return m_newestSampleNs.load(std::memory_order_acquire); }
+
+    // Receives the sample and drop counts of this source; may be shared. Only takes
+    // effect while the source is stopped, as its threads read it without a lock.
+    void setThroughputMonitor(scpThroughputMonitor* monitor);
+    scpThroughputMonitor* throughputMonitor() const { return m_monitor; }
+
 signals:
     void stateChanged(bool running);
 
     // NEW: allows sources (audio, generator, message waves) to send sample data
     void samplesReady(const float* data, int count);
+
+protected:
+    // Called once a block of 'count' samples is in the buffer, with the time it was read or generated
+    void stampSamples(qint64 producedNs, int count);
+    // Samples lost before they reached the buffer
+    void reportDropped(int count);
+
+private:
+    std::atomic<qint64> m_newestSampleNs{0};
+    scpThroughputMonitor* m_monitor = nullptr;  // Changed only while stopped
 };
@@ -1,5 +1,104 @@
 #include "scpFTDIInterface.h"
+#include "scpUringIO.h"
+#include "scpTrace.h"
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#ifdef Q_OS_UNIX
+#include <sys/uio.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+// ThreadedMode read sizing: each read covers ~10 ms of the target throughput
+static constexpr double kThreadedReadPeriodSec = 0.010;
+static constexpr int kThreadedMaxReadBytes = 4 * 1024 * 1024;
+static constexpr int kThreadedUnpacedReadBytes = 256 * 1024;
+// Longest a ThreadedMode read of a pipe or tty waits before rechecking stop()
+static constexpr int kReadPollTimeoutMs = 50;
+// Stop reading ahead once this much data is queued towards slow consumers
+static constexpr qint64 kMaxBytesInFlight = 64 * 1024 * 1024;
+// Upper bound on chunks gathered into one write (well under IOV_MAX)
+static constexpr int kMaxGatherChunks = 64;
+// Reads/writes kept in flight by the io_uring paths
+static constexpr int kUringQueueDepth = 8;
+// PacedMode: shortest tick, token bucket depth, and how often dataWritten is reported
+static constexpr qint64 kPacedMinPeriodNs = 20 * 1000;
+static constexpr double kPacedBurstSec = 0.020;
+static constexpr qint64 kPacedReportNs = 1000 * 1000;
+
+static qint64 monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void sleepUntilNs(qint64 deadlineNs) {
+#ifdef Q_OS_LINUX
+    // steady_clock is CLOCK_MONOTONIC here, so both share one time base
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadlineNs / 1000000000);
+    ts.tv_nsec = static_cast<long>(deadlineNs % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+        std::chrono::nanoseconds(deadlineNs)));
+#endif
+}
+
+// Write up to maxBytes from a run of queued chunks in one call (writev on POSIX)
+template <typename It>
+static qint64 gatherWrite(QFile& file, It begin, It end, int headOffset, qint64 maxBytes,
+                          QString& error) {
+#ifdef Q_OS_UNIX
+    struct iovec iov[kMaxGatherChunks];
+    int iovCount = 0;
+    qint64 gathered = 0;
+    int offset = headOffset;
+    for (It it = begin; it != end && iovCount < kMaxGatherChunks && gathered < maxBytes; ++it) {
+        const qint64 len = std::min<qint64>(it->size() - offset, maxBytes - gathered);
+        iov[iovCount].iov_base = const_cast<char*>(it->constData() + offset);
+        iov[iovCount].iov_len = static_cast<size_t>(len);
+        ++iovCount;
+        gathered += len;
+        offset = 0;
+    }
+    if (iovCount == 0) return 0;
+
+    ssize_t written;
+    do {
+        written = ::writev(file.handle(), iov, iovCount);
+    } while (written < 0 && errno == EINTR);
+    if (written < 0) {
+        error = QString::fromLocal8Bit(strerror(errno));
+        return -1;
+    }
+    return written;
+#else
+    qint64 total = 0;
+    int offset = headOffset;
+    for (It it = begin; it != end && total < maxBytes; ++it) {
+        const qint64 len = std::min<qint64>(it->size() - offset, maxBytes - total);
+        const qint64 written = file.write(it->constData() + offset, len);
+        if (written < 0) {
+            error = file.errorString();
+            return total > 0 ? total : -1;
+        }
+        total += written;
+        if (written < len) break;
+        offset = 0;
+    }
+    return total;
+#endif
+}
 
 // ============================================================================
 // scpFTDIInterface - Base Class Implementation
@@ -26,6 +125,180 @@ void scpFTDIInterface::setDevicePath(const QString& path) {
     m_devicePath = path;
 }
 
+// ============================================================================
+// scpMappedReplay - Whole-file mapping shared by replay slices
+// ============================================================================
+
+struct scpMappedReplay {
+    QFile file;
+    uchar* data = nullptr;
+    qint64 size = 0;
+
+    ~scpMappedReplay() {
+        if (data) file.unmap(data);
+    }
+};
+
+// ============================================================================
+// FTDIReadWorker - Threaded blocking reads for scpFTDIReader
+// ============================================================================
+
+FTDIReadWorker::FTDIReadWorker(scpFTDIReader* parent)
+    : m_parent(parent) {
+}
+
+void FTDIReadWorker::stop() {
+    m_shouldStop = true;
+    // Every wait in run() is bounded (read poll, pacing, back-off), so this returns promptly
+    wait();
+}
+
+void FTDIReadWorker::run() {
+    SCP_TRACE_THREAD_NAME("FTDI read");
+    scpFTDIReader* reader = m_parent;
+    const int chunkSize = reader->threadedChunkSize();
+    const double target = reader->m_targetThroughput;
+    const std::shared_ptr<scpMappedReplay> replay = reader->m_replay;
+    const quint64 run = reader->m_run;  // Set before this thread was started
+    QElapsedTimer clock;
+    clock.start();
+    qint64 bytesThisRun = 0;
+
+    if (!reader->m_threadTuning.isDefault()) {
+        QString message;
+        scpApplyThreadTuning(reader->m_threadTuning, &message);
+        QMetaObject::invokeMethod(reader, [reader, message]() {
+            emit reader->statusChanged(QString("Read thread: %1").arg(message));
+        }, Qt::QueuedConnection);
+    }
+
+    // Pipelined io_uring reads for regular files; anything else keeps the QFile path
+    scpUringFileReader uring;
+    bool useUring = false;
+    if (reader->m_useIoUring && !replay) {
+        useUring = !reader->m_file.isSequential() &&
+                   uring.open(reader->m_file.handle(), reader->m_file.pos(), reader->m_file.size(),
+                              chunkSize, kUringQueueDepth, reader->m_loopReplay);
+        const QString status = useUring
+            ? QString("io_uring reads: %1 x %2 bytes in flight").arg(kUringQueueDepth).arg(uring.blockSize())
+            : QString("io_uring unavailable (%1), using QFile reads")
+                  .arg(reader->m_file.isSequential() ? "not a regular file" : uring.errorString());
+        QMetaObject::invokeMethod(reader, [reader, status]() {
+            emit reader->statusChanged(status);
+        }, Qt::QueuedConnection);
+    }
+
+    // Pipes and ttys block in read() while the writer is idle: wait for data with
+    // poll() instead, so stop() never waits on a read that may not return
+    int pollFd = -1;
+#ifdef Q_OS_UNIX
+    if (!replay && !useUring && reader->m_file.isSequential()) pollFd = reader->m_file.handle();
+#endif
+
+    while (!m_shouldStop) {
+        // Back off while consumers are still working through earlier buffers
+        if (reader->m_bytesInFlight->load(std::memory_order_relaxed) > kMaxBytesInFlight) {
+            QThread::usleep(1000);
+            continue;
+        }
+
+        SCP_TRACE_SCOPE("threadedRead");
+        QByteArray data;
+        qint64 n = 0;
+        QString readError;
+        if (replay) {
+            // Zero-copy slice of the mapping; empty only at the end of a non-looping replay
+            reader->nextReplaySlice(chunkSize, data);
+            n = data.size();
+        } else if (useUring) {
+            if (!uring.ready()) {
+                // Every buffer is still with a receiver
+                QThread::usleep(1000);
+                continue;
+            }
+            n = uring.next(data, reader->m_lease);
+            if (n < 0) readError = uring.errorString();
+#ifdef Q_OS_UNIX
+        } else if (pollFd >= 0) {
+            struct pollfd pfd = {pollFd, POLLIN, 0};
+            const int ready = ::poll(&pfd, 1, kReadPollTimeoutMs);
+            if (ready == 0 || (ready < 0 && errno == EINTR)) continue;
+            if (ready > 0) {
+                // One read of whatever is there; QFile would keep reading to fill the buffer
+                data = QByteArray(chunkSize, Qt::Uninitialized);
+                do {
+                    n = ::read(pollFd, data.data(), static_cast<size_t>(chunkSize));
+                } while (n < 0 && errno == EINTR);
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+            } else {
+                n = -1;
+            }
+            if (n < 0) readError = QString::fromLocal8Bit(strerror(errno));
+#endif
+        } else {
+            // Fresh buffer per read: it is handed off whole, so it cannot be reused
+            data = QByteArray(chunkSize, Qt::Uninitialized);
+            n = reader->m_file.read(data.data(), chunkSize);
+            if (n < 0) readError = reader->m_file.errorString();
+        }
+
+        if (n < 0) {
+            const QString err = QString("Read error: %1").arg(readError);
+            QMetaObject::invokeMethod(reader, [reader, err, run]() {
+                emit reader->errorOccurred(err);
+                if (reader->m_run == run) reader->stop();
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        if (n == 0) {
+            if (!replay && reader->m_loopReplay && reader->m_file.atEnd() &&
+                !reader->m_file.isSequential() && reader->m_file.seek(0)) {
+                continue;
+            }
+            // A polled pipe or tty that was readable yet gave nothing has lost its writer
+            if (replay || useUring || pollFd >= 0 || reader->m_file.atEnd()) {
+                QMetaObject::invokeMethod(reader, [reader, run]() {
+                    if (reader->m_run != run) return;  // Queued by an earlier, already stopped run
+                    emit reader->statusChanged("End of input file reached");
+                    reader->stop();
+                }, Qt::QueuedConnection);
+                return;
+            }
+            continue;  // Device had nothing for us this time
+        }
+
+        if (!replay && !useUring) data.truncate(static_cast<int>(n));
+        reader->m_totalBytesRead.fetch_add(n, std::memory_order_relaxed);
+        bytesThisRun += n;
+
+        // Framed input: pass on the payloads only (a copy, so mapping slices end here)
+        QByteArray payload;
+        const bool deliver = reader->m_useFraming ? reader->unframe(data, payload) : true;
+
+        // The trailing queued call runs after receivers queued on the reader's thread,
+        // releases the in-flight budget and drops its hold on the mapping or io_uring
+        // buffer. Receivers on other threads take a holdDelivery() of their own.
+        reader->m_bytesInFlight->fetch_add(n, std::memory_order_relaxed);
+        if (deliver) emit reader->dataReceived(reader->m_useFraming ? payload : data);
+        emit reader->readCompleted(static_cast<int>(n));
+        QMetaObject::invokeMethod(reader, [reader, n, replay, lease = std::move(reader->m_lease)]() {
+            Q_UNUSED(replay);
+            Q_UNUSED(lease);
+            reader->m_bytesInFlight->fetch_sub(n, std::memory_order_relaxed);
+        }, Qt::QueuedConnection);
+
+        // Pace against the absolute schedule so rounding does not accumulate drift
+        if (target > 0.0) {
+            const qint64 dueNs = static_cast<qint64>(bytesThisRun / target * 1e9);
+            const qint64 aheadNs = dueNs - clock.nsecsElapsed();
+            if (aheadNs > 0) {
+                QThread::usleep(static_cast<unsigned long>(aheadNs / 1000));
+            }
+        }
+    }
+}
+
 // ============================================================================
 // scpFTDIReader - Reader Implementation (reqfRead)
 // ============================================================================
@@ -33,9 +306,21 @@ void scpFTDIInterface::setDevicePath(const QString& path) {
 scpFTDIReader::scpFTDIReader(QObject *parent)
     : scpFTDIInterface(parent)
     , m_readTimer(new QTimer(this))
+    , m_readWorker(nullptr)
     , m_samplingFrequency(1000.0)  // Default 1 kHz
     , m_bytesPerRead(256)           // Default 256 bytes
+    , m_readMode(TimerMode)
+    , m_targetThroughput(0.0)
     , m_totalBytesRead(0)
+    , m_bytesInFlight(std::make_shared<std::atomic<qint64>>(0))
+    , m_useMmap(false)
+    , m_loopReplay(false)
+    , m_useIoUring(false)
+    , m_replayOffset(0)
+    , m_useFraming(false)
+    , m_framesDecoded(0)
+    , m_framesLost(0)
+    , m_frameCrcErrors(0)
 {
     connect(m_readTimer, &QTimer::timeout, this, &scpFTDIReader::performRead);
 }
@@ -70,6 +355,76 @@ void scpFTDIReader::setBytesPerRead(int bytes) {
     emit statusChanged(QString("Bytes per read set to %1").arg(bytes));
 }
 
+void scpFTDIReader::setReadMode(ReadMode mode) {
+    if (mode == m_readMode) return;
+
+    bool wasRunning = m_isRunning;
+    if (wasRunning) stop();
+
+    m_readMode = mode;
+
+    if (wasRunning) start();
+
+    emit statusChanged(QString("Read mode set to %1")
+                       .arg(mode == ThreadedMode ? "threaded" : "timer"));
+}
+
+void scpFTDIReader::setTargetThroughput(double bytesPerSec) {
+    if (bytesPerSec < 0) {
+        emit errorOccurred("Target throughput must not be negative");
+        return;
+    }
+
+    bool wasRunning = m_isRunning;
+    if (wasRunning) stop();
+
+    m_targetThroughput = bytesPerSec;
+
+    if (wasRunning) start();
+
+    emit statusChanged(QString("Target throughput set to %1 bytes/s").arg(bytesPerSec));
+}
+
+int scpFTDIReader::threadedChunkSize() const {
+    if (m_targetThroughput <= 0.0) {
+        return std::max(m_bytesPerRead, kThreadedUnpacedReadBytes);
+    }
+    const double perPeriod = m_targetThroughput * kThreadedReadPeriodSec;
+    return static_cast<int>(std::clamp(perPeriod, static_cast<double>(m_bytesPerRead),
+                                       static_cast<double>(kThreadedMaxReadBytes)));
+}
+
+bool scpFTDIReader::nextReplaySlice(int maxBytes, QByteArray& out) {
+    if (!m_replay || m_replay->size == 0) {
+        out.clear();
+        return false;
+    }
+    if (m_replayOffset >= m_replay->size) {
+        if (!m_loopReplay) {
+            out.clear();
+            return false;
+        }
+        m_replayOffset = 0;
+    }
+    // Slices never straddle the end of the file; a looping replay wraps on the next call
+    const qint64 n = std::min<qint64>(maxBytes, m_replay->size - m_replayOffset);
+    out = QByteArray::fromRawData(reinterpret_cast<const char*>(m_replay->data + m_replayOffset),
+                                  static_cast<qsizetype>(n));
+    m_replayOffset += n;
+    return true;
+}
+
+bool scpFTDIReader::unframe(const QByteArray& raw, QByteArray& payload) {
+    // Runs on the reading thread; returns true when there is payload to deliver
+    const int lost = m_decoder.decode(raw, payload);
+    const scpFrameDecoder::Stats& st = m_decoder.stats();
+    m_framesDecoded.store(st.framesDecoded, std::memory_order_relaxed);
+    m_framesLost.store(st.framesLost, std::memory_order_relaxed);
+    m_frameCrcErrors.store(st.crcErrors, std::memory_order_relaxed);
+    if (lost > 0) emit framesLost(lost);
+    return !payload.isEmpty();
+}
+
 bool scpFTDIReader::open() {
     if (m_isOpen) {
         emit errorOccurred("Device already open");
@@ -87,15 +442,61 @@ bool scpFTDIReader::open() {
         return false;
     }
     
+    if (m_useMmap) {
+        // Map the whole file once; devices and pipes cannot be mapped and fall back to reads
+        auto replay = std::make_shared<scpMappedReplay>();
+        replay->file.setFileName(m_devicePath);
+        if (!m_file.isSequential() && replay->file.open(QIODevice::ReadOnly)) {
+            replay->size = replay->file.size();
+            replay->data = replay->size > 0 ? replay->file.map(0, replay->size) : nullptr;
+        }
+        if (replay->data) {
+            m_replay = replay;
+            m_replayOffset = 0;
+        } else {
+            emit statusChanged("Memory-mapped replay unavailable, using buffered reads");
+        }
+    }
+    
     m_isOpen = true;
     m_totalBytesRead = 0;
-    emit statusChanged(QString("Reader opened: %1").arg(m_devicePath));
+    m_decoder.reset();
+    m_framesDecoded = 0;
+    m_framesLost = 0;
+    m_frameCrcErrors = 0;
+    emit statusChanged(QString("Reader opened: %1%2%3").arg(m_devicePath)
+                       .arg(m_replay ? " (memory-mapped)" : "")
+                       .arg(m_useFraming ? " (framed)" : ""));
     return true;
 }
 
+std::shared_ptr<void> scpFTDIReader::holdDelivery(qint64 bytes) {
+    std::shared_ptr<std::atomic<qint64>> inFlight = m_bytesInFlight;
+    inFlight->fetch_add(bytes, std::memory_order_relaxed);
+    return std::shared_ptr<void>(nullptr, [inFlight, bytes, replay = m_replay, lease = m_lease](void*) {
+        Q_UNUSED(replay);
+        Q_UNUSED(lease);
+        inFlight->fetch_sub(bytes, std::memory_order_relaxed);
+    });
+}
+
+std::shared_ptr<void> scpFTDIReader::reserveDelivery(qint64 bytes) {
+    m_bytesInFlight->fetch_add(bytes, std::memory_order_relaxed);
+    if (m_lease) return m_lease;
+    return m_replay;
+}
+
+void scpFTDIReader::releaseDelivery(qint64 bytes) {
+    m_bytesInFlight->fetch_sub(bytes, std::memory_order_relaxed);
+}
+
 void scpFTDIReader::close() {
     stop();
     
+    // Slices still queued for delivery keep their own reference to the mapping
+    m_replay.reset();
+    m_replayOffset = 0;
+    
     if (m_file.isOpen()) {
         m_file.close();
     }
@@ -114,6 +515,16 @@ void scpFTDIReader::start() {
         return;
     }
     
+    if (m_readMode == ThreadedMode) {
+        m_readWorker = new FTDIReadWorker(this);
+        ++m_run;
+        m_isRunning = true;
+        m_readWorker->start(QThread::HighPriority);
+        emit statusChanged(QString("Reader started: threaded, %1 bytes/read, target %2 bytes/s")
+                           .arg(threadedChunkSize()).arg(m_targetThroughput));
+        return;
+    }
+
     // Calculate timer interval from sampling frequency
     int intervalMs = static_cast<int>(1000.0 / m_samplingFrequency);
     if (intervalMs < 1) intervalMs = 1;
@@ -130,11 +541,23 @@ void scpFTDIReader::stop() {
     }
     
     m_readTimer->stop();
+    if (m_readWorker) {
+        m_readWorker->stop();
+        delete m_readWorker;
+        m_readWorker = nullptr;
+    }
     m_isRunning = false;
-    emit statusChanged(QString("Reader stopped. Total bytes read: %1").arg(m_totalBytesRead));
+    if (m_useFraming) {
+        emit statusChanged(QString("Reader stopped. Total bytes read: %1, frames: %2, lost: %3, CRC errors: %4")
+                           .arg(m_totalBytesRead.load()).arg(framesDecoded()).arg(framesLost())
+                           .arg(frameCrcErrors()));
+        return;
+    }
+    emit statusChanged(QString("Reader stopped. Total bytes read: %1").arg(m_totalBytesRead.load()));
 }
 
 void scpFTDIReader::performRead() {
+    SCP_TRACE_SCOPE("performRead");
     if (!m_isOpen || !m_file.isOpen()) {
         emit errorOccurred("Device not open");
         stop();
@@ -142,9 +565,18 @@ void scpFTDIReader::performRead() {
     }
     
     // Read specified number of bytes
-    QByteArray data = m_file.read(m_bytesPerRead);
+    QByteArray data;
+    if (m_replay) {
+        nextReplaySlice(m_bytesPerRead, data);
+    } else {
+        data = m_file.read(m_bytesPerRead);
+        if (data.isEmpty() && m_loopReplay && m_file.atEnd() &&
+            !m_file.isSequential() && m_file.seek(0)) {
+            data = m_file.read(m_bytesPerRead);
+        }
+    }
     
-    if (data.isEmpty() && m_file.atEnd()) {
+    if (data.isEmpty() && (m_replay || m_file.atEnd())) {
         // End of file reached
         emit statusChanged("End of input file reached");
         stop();
@@ -157,11 +589,118 @@ void scpFTDIReader::performRead() {
         return;
     }
     
-    m_totalBytesRead += data.size();
+    m_totalBytesRead.fetch_add(data.size(), std::memory_order_relaxed);
     
-    // Emit the data
-    emit dataReceived(data);
+    // Emit the data (payloads only when the input is framed)
+    if (m_useFraming) {
+        QByteArray payload;
+        if (unframe(data, payload)) emit dataReceived(payload);
+    } else {
+        emit dataReceived(data);
+    }
     emit readCompleted(data.size());
+    
+    if (m_replay) {
+        // Keep the mapping alive for receivers queued on this thread (see holdDelivery())
+        QMetaObject::invokeMethod(this, [keep = m_replay]() { Q_UNUSED(keep); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+// ============================================================================
+// FTDIWriteWorker - Paced writes for scpFTDIWriter
+// ============================================================================
+
+FTDIWriteWorker::FTDIWriteWorker(scpFTDIWriter* parent)
+    : m_parent(parent) {
+}
+
+void FTDIWriteWorker::stop() {
+    m_shouldStop = true;
+    wait();
+}
+
+void FTDIWriteWorker::run() {
+    SCP_TRACE_THREAD_NAME("FTDI write");
+    scpFTDIWriter* writer = m_parent;
+    const quint64 run = writer->m_run;  // Set before this thread was started
+    if (!writer->m_threadTuning.isDefault()) {
+        QString message;
+        scpApplyThreadTuning(writer->m_threadTuning, &message);
+        QMetaObject::invokeMethod(writer, [writer, message]() {
+            emit writer->statusChanged(QString("Write thread: %1").arg(message));
+        }, Qt::QueuedConnection);
+    }
+    const double rate = writer->effectiveRate();
+    // One tick per write's worth of tokens, but never shorter than the minimum period
+    const qint64 periodNs = std::max<qint64>(kPacedMinPeriodNs,
+        static_cast<qint64>(writer->m_bytesPerWrite / rate * 1e9));
+    // Bucket depth: enough to absorb a late wake-up without a lasting rate loss
+    const double burst = std::max(2.0 * writer->m_bytesPerWrite, rate * kPacedBurstSec);
+
+    std::vector<QByteArray> batch;
+    batch.reserve(kMaxGatherChunks);
+    double tokens = 0.0;
+    qint64 reportBytes = 0;
+    bool wasEmpty = writer->m_queuedBytes == 0;
+    const qint64 startNs = monotonicNs();
+    qint64 lastNs = startNs;
+    qint64 lastReportNs = startNs;
+    qint64 deadline = startNs + periodNs;
+
+    while (!m_shouldStop) {
+        sleepUntilNs(deadline);
+        const qint64 now = monotonicNs();
+        const qint64 lateNs = now - deadline;
+        writer->m_pacedTicks.fetch_add(1, std::memory_order_relaxed);
+        writer->m_pacedJitterSumNs.fetch_add(lateNs, std::memory_order_relaxed);
+        if (lateNs > writer->m_pacedJitterMaxNs.load(std::memory_order_relaxed)) {
+            writer->m_pacedJitterMaxNs.store(lateNs, std::memory_order_relaxed);
+        }
+        // Stay on the absolute grid; ticks already missed are skipped, not replayed
+        deadline += periodNs;
+        if (deadline <= now) {
+            const qint64 missed = (now - deadline) / periodNs + 1;
+            writer->m_pacedMissedTicks.fetch_add(missed, std::memory_order_relaxed);
+            deadline += missed * periodNs;
+        }
+
+        tokens = std::min(burst, tokens + (now - lastNs) * rate / 1e9);
+        lastNs = now;
+
+        const qint64 allowance = static_cast<qint64>(tokens);
+        if (allowance > 0 && writer->m_queuedBytes > 0) {
+            SCP_TRACE_SCOPE("pacedWrite");
+            const qint64 written = writer->writeQueued(allowance, batch);
+            if (written < 0) {
+                const QString err = QString("Write error: %1").arg(writer->m_lastWriteError);
+                QMetaObject::invokeMethod(writer, [writer, err, run]() {
+                    emit writer->errorOccurred(err);
+                    if (writer->m_run == run) writer->stop();
+                }, Qt::QueuedConnection);
+                return;
+            }
+            tokens -= written;
+            reportBytes += written;
+            writer->m_pacedBytes.fetch_add(written, std::memory_order_relaxed);
+        }
+        writer->m_pacedElapsedNs.store(now - startNs, std::memory_order_relaxed);
+
+        // Aggregate signals: one dataWritten per report period, queueEmpty on running dry
+        const bool empty = writer->m_queuedBytes == 0;
+        if (reportBytes > 0 && (empty || now - lastReportNs >= kPacedReportNs)) {
+            emit writer->dataWritten(static_cast<int>(reportBytes));
+            reportBytes = 0;
+            lastReportNs = now;
+        }
+        if (empty && !wasEmpty) {
+            emit writer->writeCompleted();
+            emit writer->queueEmpty();
+        }
+        wasEmpty = empty;
+    }
+
+    if (reportBytes > 0) emit writer->dataWritten(static_cast<int>(reportBytes));
 }
 
 // ============================================================================
@@ -171,9 +710,23 @@ void scpFTDIReader::performRead() {
 scpFTDIWriter::scpFTDIWriter(QObject *parent)
     : scpFTDIInterface(parent)
     , m_writeTimer(new QTimer(this))
+    , m_writeWorker(nullptr)
     , m_outputFrequency(1000.0)  // Default 1 kHz
     , m_bytesPerWrite(256)        // Default 256 bytes
+    , m_writeMode(TimerMode)
+    , m_targetRate(0.0)
+    , m_headOffset(0)
+    , m_queuedBytes(0)
     , m_totalBytesWritten(0)
+    , m_pacedRate(0.0)
+    , m_pacedBytes(0)
+    , m_pacedElapsedNs(0)
+    , m_pacedTicks(0)
+    , m_pacedMissedTicks(0)
+    , m_pacedJitterSumNs(0)
+    , m_pacedJitterMaxNs(0)
+    , m_useIoUring(false)
+    , m_useFraming(false)
 {
     connect(m_writeTimer, &QTimer::timeout, this, &scpFTDIWriter::performWrite);
 }
@@ -208,6 +761,52 @@ void scpFTDIWriter::setBytesPerWrite(int bytes) {
     emit statusChanged(QString("Bytes per write set to %1").arg(bytes));
 }
 
+void scpFTDIWriter::setWriteMode(WriteMode mode) {
+    if (m_isRunning) {
+        emit errorOccurred("Cannot change write mode while running");
+        return;
+    }
+    m_writeMode = mode;
+    emit statusChanged(QString("Write mode set to %1")
+                       .arg(mode == PacedMode ? "paced" : "timer"));
+}
+
+void scpFTDIWriter::setTargetRate(double bytesPerSec) {
+    if (bytesPerSec < 0) {
+        emit errorOccurred("Target rate must not be negative");
+        return;
+    }
+
+    bool wasRunning = m_isRunning;
+    if (wasRunning) stop();
+
+    m_targetRate = bytesPerSec;
+
+    if (wasRunning) start();
+
+    emit statusChanged(QString("Target rate set to %1 bytes/s").arg(bytesPerSec));
+}
+
+double scpFTDIWriter::effectiveRate() const {
+    return m_targetRate > 0.0 ? m_targetRate : m_outputFrequency * m_bytesPerWrite;
+}
+
+scpFTDIWriter::PacingStats scpFTDIWriter::pacingStats() const {
+    PacingStats stats;
+    stats.targetBytesPerSec = m_pacedRate.load(std::memory_order_relaxed);
+    stats.ticks = m_pacedTicks.load(std::memory_order_relaxed);
+    stats.missedTicks = m_pacedMissedTicks.load(std::memory_order_relaxed);
+    const qint64 elapsedNs = m_pacedElapsedNs.load(std::memory_order_relaxed);
+    if (elapsedNs > 0) {
+        stats.achievedBytesPerSec = m_pacedBytes.load(std::memory_order_relaxed) * 1e9 / elapsedNs;
+    }
+    if (stats.ticks > 0) {
+        stats.meanJitterUs = m_pacedJitterSumNs.load(std::memory_order_relaxed) / 1e3 / stats.ticks;
+    }
+    stats.maxJitterUs = m_pacedJitterMaxNs.load(std::memory_order_relaxed) / 1e3;
+    return stats;
+}
+
 bool scpFTDIWriter::open() {
     if (m_isOpen) {
         emit errorOccurred("Device already open");
@@ -219,28 +818,62 @@ bool scpFTDIWriter::open() {
         return false;
     }
     
+    // Unbuffered: gather writes go straight to the descriptor and must not
+    // overtake bytes sitting in a QFile buffer
     m_file.setFileName(m_devicePath);
-    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
         emit errorOccurred(QString("Failed to open device: %1").arg(m_file.errorString()));
         return false;
     }
     
+    if (m_useIoUring) {
+        // Offsets are tracked by the ring, so only regular files qualify
+        auto uring = std::make_unique<scpUringFileWriter>();
+        if (!m_file.isSequential() &&
+            uring->open(m_file.handle(), 0, m_bytesPerWrite, kUringQueueDepth)) {
+            m_uring = std::move(uring);
+        } else {
+            emit statusChanged(QString("io_uring unavailable (%1), using synchronous writes")
+                               .arg(m_file.isSequential() ? "not a regular file" : uring->errorString()));
+        }
+    }
+    
     m_isOpen = true;
     m_totalBytesWritten = 0;
-    m_writeQueue.clear();
-    emit statusChanged(QString("Writer opened: %1").arg(m_devicePath));
+    clearQueue();
+    m_encoder.reset();
+    emit statusChanged(QString("Writer opened: %1%2%3").arg(m_devicePath)
+                       .arg(m_uring ? " (io_uring)" : "")
+                       .arg(m_useFraming ? " (framed)" : ""));
     return true;
 }
 
 void scpFTDIWriter::close() {
     stop();
     
+    if (m_uring) {
+        // Push the remaining queue through the ring and wait for every write
+        while (m_queuedBytes > 0) {
+            if (!m_uring->acquire()) {
+                const qint64 done = m_uring->reap(true);
+                if (done < 0) break;
+                m_totalBytesWritten += done;
+            }
+            if (!submitUringWrite()) break;
+        }
+        const qint64 done = m_uring->drain();
+        if (done > 0) m_totalBytesWritten += done;
+        m_uring.reset();
+        // The descriptor's own offset was never advanced; leftovers cannot be appended
+        clearQueue();
+    }
+    
     if (m_file.isOpen()) {
         // Flush any remaining data
-        if (!m_writeQueue.isEmpty()) {
-            m_file.write(m_writeQueue);
-            m_file.flush();
+        while (m_queuedBytes > 0) {
+            if (writeQueued(m_queuedBytes, m_gatherBatch) <= 0) break;
         }
+        clearQueue();
         m_file.close();
     }
     
@@ -258,6 +891,25 @@ void scpFTDIWriter::start() {
         return;
     }
     
+    if (m_writeMode == PacedMode && m_uring) {
+        emit statusChanged("io_uring writes are not paced, using timer mode");
+    } else if (m_writeMode == PacedMode) {
+        m_pacedRate = effectiveRate();
+        m_pacedBytes = 0;
+        m_pacedElapsedNs = 0;
+        m_pacedTicks = 0;
+        m_pacedMissedTicks = 0;
+        m_pacedJitterSumNs = 0;
+        m_pacedJitterMaxNs = 0;
+        m_writeWorker = new FTDIWriteWorker(this);
+        ++m_run;
+        m_isRunning = true;
+        m_writeWorker->start(QThread::HighPriority);
+        emit statusChanged(QString("Writer started: paced, %1 bytes/s, %2 bytes/write")
+                           .arg(m_pacedRate.load()).arg(m_bytesPerWrite));
+        return;
+    }
+    
     // Calculate timer interval from output frequency
     int intervalMs = static_cast<int>(1000.0 / m_outputFrequency);
     if (intervalMs < 1) intervalMs = 1;
@@ -274,51 +926,182 @@ void scpFTDIWriter::stop() {
     }
     
     m_writeTimer->stop();
+    if (m_writeWorker) {
+        m_writeWorker->stop();
+        delete m_writeWorker;
+        m_writeWorker = nullptr;
+        m_isRunning = false;
+        const PacingStats stats = pacingStats();
+        emit statusChanged(QString("Writer stopped. Queue size: %1, Total written: %2, "
+                                   "achieved %3 of %4 bytes/s, jitter mean %5 us max %6 us, missed ticks %7")
+                           .arg(m_queuedBytes.load()).arg(m_totalBytesWritten)
+                           .arg(stats.achievedBytesPerSec, 0, 'f', 0).arg(stats.targetBytesPerSec, 0, 'f', 0)
+                           .arg(stats.meanJitterUs, 0, 'f', 1).arg(stats.maxJitterUs, 0, 'f', 1)
+                           .arg(stats.missedTicks));
+        return;
+    }
     m_isRunning = false;
     emit statusChanged(QString("Writer stopped. Queue size: %1, Total written: %2")
-                       .arg(m_writeQueue.size()).arg(m_totalBytesWritten));
+                       .arg(m_queuedBytes.load()).arg(m_totalBytesWritten));
 }
 
 void scpFTDIWriter::queueData(const QByteArray& data) {
-    m_writeQueue.append(data);
+    if (data.isEmpty()) return;
+    QMutexLocker lock(&m_queueMutex);
+    if (m_useFraming) {
+        // Each queued chunk holds whole frames; data is split at the payload size
+        const QByteArray frames = m_encoder.encode(data);
+        m_writeChunks.push_back(frames);
+        m_queuedBytes += frames.size();
+        return;
+    }
+    // Implicit sharing: the chunk is referenced, not copied
+    m_writeChunks.push_back(data);
+    m_queuedBytes += data.size();
+}
+
+qint64 scpFTDIWriter::queuedDataSize() const {
+    return m_queuedBytes;
 }
 
-int scpFTDIWriter::queuedDataSize() const {
-    return m_writeQueue.size();
+void scpFTDIWriter::clearQueue() {
+    QMutexLocker lock(&m_queueMutex);
+    m_writeChunks.clear();
+    m_headOffset = 0;
+    m_queuedBytes = 0;
+}
+
+qint64 scpFTDIWriter::writeQueued(qint64 maxBytes, std::vector<QByteArray>& batch) {
+    // Write up to maxBytes from the front of the chunk queue in one call.
+    // The front chunks are referenced under the lock and written without it:
+    // producers only append, and the writing thread is the only consumer
+    int offset = 0;
+    {
+        QMutexLocker lock(&m_queueMutex);
+        batch.clear();
+        offset = m_headOffset;
+        qint64 covered = -offset;
+        for (auto it = m_writeChunks.begin(); it != m_writeChunks.end() &&
+             covered < maxBytes && static_cast<int>(batch.size()) < kMaxGatherChunks; ++it) {
+            batch.push_back(*it);
+            covered += it->size();
+        }
+    }
+    if (batch.empty()) return 0;
+
+    const qint64 written = gatherWrite(m_file, batch.begin(), batch.end(), offset, maxBytes,
+                                       m_lastWriteError);
+    batch.clear();
+    if (written > 0) {
+        QMutexLocker lock(&m_queueMutex);
+        consumeQueued(written);
+        m_totalBytesWritten += written;
+    }
+    return written;
+}
+
+qint64 scpFTDIWriter::copyQueued(char* dst, qint64 maxBytes) const {
+    // Copy up to maxBytes from the front of the chunk queue without consuming it
+    qint64 copied = 0;
+    int offset = m_headOffset;
+    for (auto it = m_writeChunks.begin(); it != m_writeChunks.end() && copied < maxBytes; ++it) {
+        const qint64 len = std::min<qint64>(it->size() - offset, maxBytes - copied);
+        memcpy(dst + copied, it->constData() + offset, static_cast<size_t>(len));
+        copied += len;
+        offset = 0;
+    }
+    return copied;
+}
+
+void scpFTDIWriter::consumeQueued(qint64 bytes) {
+    // Drop fully written chunks and advance into the first partially written one
+    m_queuedBytes -= bytes;
+    while (bytes > 0 && !m_writeChunks.empty()) {
+        const qint64 remaining = m_writeChunks.front().size() - m_headOffset;
+        if (bytes >= remaining) {
+            bytes -= remaining;
+            m_writeChunks.pop_front();
+            m_headOffset = 0;
+        } else {
+            m_headOffset += static_cast<int>(bytes);
+            bytes = 0;
+        }
+    }
 }
 
 void scpFTDIWriter::performWrite() {
+    SCP_TRACE_SCOPE("performWrite");
     if (!m_isOpen || !m_file.isOpen()) {
         emit errorOccurred("Device not open");
         stop();
         return;
     }
     
-    if (m_writeQueue.isEmpty()) {
-        emit queueEmpty();
+    if (m_uring) {
+        performUringWrite();
         return;
     }
     
-    // Write specified number of bytes
-    int bytesToWrite = qMin(m_bytesPerWrite, m_writeQueue.size());
-    QByteArray data = m_writeQueue.left(bytesToWrite);
+    if (m_queuedBytes == 0) {
+        emit queueEmpty();
+        return;
+    }
     
-    qint64 written = m_file.write(data);
+    // Write specified number of bytes, gathered across queued chunks (consumed on success)
+    qint64 written = writeQueued(m_bytesPerWrite, m_gatherBatch);
     
     if (written < 0) {
-        emit errorOccurred(QString("Write error: %1").arg(m_file.errorString()));
+        emit errorOccurred(QString("Write error: %1").arg(m_lastWriteError));
         stop();
         return;
     }
     
-    // Remove written data from queue
-    m_writeQueue.remove(0, written);
-    m_totalBytesWritten += written;
-    
     emit dataWritten(written);
     
-    if (m_writeQueue.isEmpty()) {
+    if (m_queuedBytes == 0) {
         emit writeCompleted();
         emit queueEmpty();
     }
-}
\ No newline at end of file
+}
+
+bool scpFTDIWriter::submitUringWrite() {
+    // Stage the next bytesPerWrite bytes in a registered buffer; the queue is
+    // consumed at submission since the ring no longer needs the chunks
+    char* buffer = m_uring->acquire();
+    if (!buffer) return false;
+    QMutexLocker lock(&m_queueMutex);
+    const qint64 len = copyQueued(buffer, std::min(m_bytesPerWrite, m_uring->blockSize()));
+    if (len <= 0) return false;
+    if (!m_uring->submit(static_cast<int>(len))) {
+        m_lastWriteError = m_uring->errorString();
+        return false;
+    }
+    consumeQueued(len);
+    return true;
+}
+
+void scpFTDIWriter::performUringWrite() {
+    // Collect writes that finished since the last tick, without blocking
+    const qint64 done = m_uring->reap(false);
+    if (done < 0) {
+        emit errorOccurred(QString("Write error: %1").arg(m_uring->errorString()));
+        stop();
+        return;
+    }
+    
+    if (m_queuedBytes > 0 && m_uring->acquire() && !submitUringWrite()) {
+        emit errorOccurred(QString("Write error: %1").arg(m_lastWriteError));
+        stop();
+        return;
+    }
+    
+    if (done > 0) {
+        m_totalBytesWritten += done;
+        emit dataWritten(static_cast<int>(done));
+    }
+    
+    if (m_queuedBytes == 0) {
+        if (done > 0 && m_uring->inFlight() == 0) emit writeCompleted();
+        emit queueEmpty();
+    }
+}
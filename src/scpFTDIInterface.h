@@ -3,9 +3,17 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QThread>
 #include <QFile>
 #include <QByteArray>
 #include <QString>
+#include <QMutex>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "scpFrameCodec.h"
+#include "scpIoThread.h"
 
 /**
  * @brief Base class for FTDI 245R interface operations
@@ -42,25 +50,89 @@ protected:
     QFile m_file;
 };
 
+class FTDIReadWorker;
+class FTDIWriteWorker;
+struct scpMappedReplay;
+class scpUringFileWriter;
+
 /**
  * @brief FTDI Reader class - implements reqfRead
  * 
  * Continuously reads data bytes from USB port at user-defined
- * sampling frequency and specified number of bytes per read
+ * sampling frequency and specified number of bytes per read.
+ *
+ * In ThreadedMode the reads run on a dedicated thread instead of a
+ * QTimer: each read is sized from the target throughput (bytes/s) and
+ * the whole buffer is handed off through dataReceived.
+ *
+ * With memory-mapped replay enabled, a regular input file is mapped once
+ * on open() and dataReceived carries QByteArray::fromRawData slices of
+ * the mapping (no per-read allocation or copy). Slices stay valid until
+ * close() and until deliveries queued on the reader's thread have run;
+ * receivers that keep data longer, or live on other threads, must copy.
+ *
+ * With io_uring enabled (Linux builds with liburing), ThreadedMode reads
+ * of a regular file keep several large reads in flight against registered
+ * buffers; when io_uring is unavailable the QFile reads are used instead.
+ *
+ * With framing enabled the input is treated as an scpFrameEncoder stream:
+ * dataReceived carries only the recovered payloads, corrupted frames are
+ * skipped with a resync on the next sync word, and sequence gaps are
+ * reported through framesLost. readCompleted still counts raw bytes.
  */
 class scpFTDIReader : public scpFTDIInterface {
     Q_OBJECT
 
 public:
+    enum ReadMode {
+        TimerMode,      // QTimer-driven, one read of bytesPerRead per tick (<= 1 kHz)
+        ThreadedMode    // Blocking reads on a worker thread, paced by target throughput
+    };
+
     explicit scpFTDIReader(QObject *parent = nullptr);
     ~scpFTDIReader() override;
 
     // Configuration
     void setSamplingFrequency(double frequencyHz);
     void setBytesPerRead(int bytes);
+    void setReadMode(ReadMode mode);
+    // Target rate for ThreadedMode in bytes/s; 0 reads as fast as the device delivers
+    void setTargetThroughput(double bytesPerSec);
+    // Replay options for file-simulated devices (take effect on next open()/EOF)
+    void setMemoryMappedReplay(bool enable) { m_useMmap = enable; }
+    void setLoopReplay(bool enable) { m_loopReplay = enable; }
+    // Pipelined io_uring reads in ThreadedMode (takes effect on next start())
+    void setIoUring(bool enable) { m_useIoUring = enable; }
+    // Decode framed input (takes effect on next start())
+    void setFraming(bool enable) { m_useFraming = enable; }
+    // CPU pinning / realtime priority of the ThreadedMode read thread (next start())
+    void setThreadTuning(const scpThreadTuning& tuning) { m_threadTuning = tuning; }
+    scpThreadTuning threadTuning() const { return m_threadTuning; }
     
     double samplingFrequency() const { return m_samplingFrequency; }
     int bytesPerRead() const { return m_bytesPerRead; }
+    ReadMode readMode() const { return m_readMode; }
+    double targetThroughput() const { return m_targetThroughput; }
+    bool memoryMappedReplay() const { return m_useMmap; }
+    bool loopReplay() const { return m_loopReplay; }
+    bool ioUring() const { return m_useIoUring; }
+    bool isMapped() const { return m_replay != nullptr; }
+    bool framing() const { return m_useFraming; }
+
+    // For receivers that pass dataReceived() on through a queued call of their own:
+    // take this in a DirectConnection slot and keep it in that call. Until its last copy
+    // is gone the bytes count against the in-flight budget, a replay slice stays mapped
+    // and an io_uring buffer is not read into again. May outlive the reader.
+    std::shared_ptr<void> holdDelivery(qint64 bytes);
+    // The same without allocating: counts the bytes until releaseDelivery(bytes) and
+    // returns what keeps the block valid (null for plain reads). Call it the same way.
+    std::shared_ptr<void> reserveDelivery(qint64 bytes);
+    void releaseDelivery(qint64 bytes);
+
+    // Framing statistics since open() (thread-safe)
+    qint64 framesDecoded() const { return m_framesDecoded.load(std::memory_order_relaxed); }
+    qint64 framesLost() const { return m_framesLost.load(std::memory_order_relaxed); }
+    qint64 frameCrcErrors() const { return m_frameCrcErrors.load(std::memory_order_relaxed); }
 
     // Operations
     bool open() override;
@@ -71,36 +143,140 @@ public:
 signals:
     void dataReceived(const QByteArray& data);
     void readCompleted(int bytesRead);
+    // Frames missing from the sequence; emitted from the reading thread
+    void framesLost(int count);
 
 private slots:
     void performRead();
 
 private:
+    friend class FTDIReadWorker;
+    int threadedChunkSize() const;
+    bool nextReplaySlice(int maxBytes, QByteArray& out);
+    bool unframe(const QByteArray& raw, QByteArray& payload);
+
     QTimer* m_readTimer;
+    FTDIReadWorker* m_readWorker;
     double m_samplingFrequency;  // Hz
     int m_bytesPerRead;
-    qint64 m_totalBytesRead;
+    ReadMode m_readMode;
+    double m_targetThroughput;   // bytes/s, ThreadedMode only
+    scpThreadTuning m_threadTuning;
+    std::atomic<qint64> m_totalBytesRead;  // Added to by the ThreadedMode worker
+    quint64 m_run = 0;  // Counts ThreadedMode starts, so calls queued by a finished run are ignored
+    std::shared_ptr<std::atomic<qint64>> m_bytesInFlight;  // Handed off but not yet delivered; shared with holds
+
+    // Replay of file-simulated input
+    bool m_useMmap;
+    bool m_loopReplay;
+    bool m_useIoUring;
+    std::shared_ptr<scpMappedReplay> m_replay;  // Shared with in-flight slices
+    std::shared_ptr<void> m_lease;  // io_uring buffer of the block being emitted; worker thread only
+    qint64 m_replayOffset;
+
+    // Framing: the decoder is only touched by whichever thread is reading
+    bool m_useFraming;
+    scpFrameDecoder m_decoder;
+    std::atomic<qint64> m_framesDecoded;
+    std::atomic<qint64> m_framesLost;
+    std::atomic<qint64> m_frameCrcErrors;
+};
+
+// Worker thread that performs blocking reads for scpFTDIReader::ThreadedMode
+class FTDIReadWorker : public QThread {
+    Q_OBJECT
+public:
+    explicit FTDIReadWorker(scpFTDIReader* parent);
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    scpFTDIReader* m_parent;
+    std::atomic<bool> m_shouldStop{false};
 };
 
 /**
  * @brief FTDI Writer class - implements reqfWrite
  * 
  * Transmits data bytes to USB port at user-defined output
- * frequency and specified number of bytes per write
+ * frequency and specified number of bytes per write.
+ *
+ * Pending output is kept as a queue of implicitly shared chunks; each
+ * write gathers up to bytesPerWrite bytes across chunks (writev on POSIX)
+ * so queue cost is proportional to the bytes written, not the backlog.
+ *
+ * With io_uring enabled and a regular output file, each write is copied
+ * into a registered buffer and submitted asynchronously, so the timer
+ * thread never waits on storage; dataWritten reports completed writes.
+ *
+ * With framing enabled, queued data is wrapped into scpFrameEncoder frames
+ * (sync word, sequence number, length, CRC-32C) before it is queued.
+ *
+ * In PacedMode the writes run on a dedicated thread instead of a QTimer.
+ * The thread sleeps to absolute deadlines (clock_nanosleep on Linux) and
+ * spends a token bucket filled at the target rate in bytes/s, so output
+ * frequencies above 1 kHz are possible and the rate does not drift with
+ * event-loop load. The bucket holds up to 20 ms of tokens, so late wake-ups
+ * are made up with a bounded burst; missed deadlines are skipped rather
+ * than accumulated. dataWritten is then reported in aggregate about
+ * once per millisecond, and queueEmpty only when the queue runs dry.
+ * pacingStats() reports the achieved rate and wake-up jitter. io_uring
+ * writes are not paced; a writer opened with io_uring falls back to
+ * TimerMode.
  */
 class scpFTDIWriter : public scpFTDIInterface {
     Q_OBJECT
 
 public:
+    enum WriteMode {
+        TimerMode,      // QTimer-driven, one write of bytesPerWrite per tick (<= 1 kHz)
+        PacedMode       // Worker thread with absolute deadlines and a byte token bucket
+    };
+
+    struct PacingStats {
+        double targetBytesPerSec = 0.0;
+        double achievedBytesPerSec = 0.0;
+        double meanJitterUs = 0.0;   // Wake-up lateness against the deadline
+        double maxJitterUs = 0.0;
+        qint64 ticks = 0;
+        qint64 missedTicks = 0;      // Woke more than one period late
+    };
+
     explicit scpFTDIWriter(QObject *parent = nullptr);
     ~scpFTDIWriter() override;
 
     // Configuration
     void setOutputFrequency(double frequencyHz);
     void setBytesPerWrite(int bytes);
+    void setWriteMode(WriteMode mode);
+    // Token rate for PacedMode in bytes/s; 0 = outputFrequency * bytesPerWrite
+    void setTargetRate(double bytesPerSec);
+    // CPU pinning / realtime priority of the PacedMode write thread (next start())
+    void setThreadTuning(const scpThreadTuning& tuning) { m_threadTuning = tuning; }
+    scpThreadTuning threadTuning() const { return m_threadTuning; }
     
     double outputFrequency() const { return m_outputFrequency; }
     int bytesPerWrite() const { return m_bytesPerWrite; }
+    WriteMode writeMode() const { return m_writeMode; }
+    double targetRate() const { return m_targetRate; }
+    // Rate PacedMode actually aims for
+    double effectiveRate() const;
+    // Statistics of the current or last PacedMode run (thread-safe)
+    PacingStats pacingStats() const;
+
+    // Asynchronous io_uring writes to regular files (takes effect on next open())
+    void setIoUring(bool enable) { m_useIoUring = enable; }
+    bool ioUring() const { return m_useIoUring; }
+    bool isUsingIoUring() const { return m_uring != nullptr; }
+
+    // Frame queued data; the sequence restarts at zero on open()
+    void setFraming(bool enable) { m_useFraming = enable; }
+    bool framing() const { return m_useFraming; }
+    void setFramePayloadSize(int bytes) { m_encoder.setMaxPayload(bytes); }
+    int framePayloadSize() const { return m_encoder.maxPayload(); }
+    qint64 framesEncoded() const { return m_encoder.framesEncoded(); }
 
     // Operations
     bool open() override;
@@ -108,9 +284,9 @@ public:
     void start();
     void stop();
     
-    // Queue data for writing
+    // Queue data for writing (thread-safe)
     void queueData(const QByteArray& data);
-    int queuedDataSize() const;
+    qint64 queuedDataSize() const;
 
 signals:
     void dataWritten(int bytesWritten);
@@ -121,11 +297,58 @@ private slots:
     void performWrite();
 
 private:
+    friend class FTDIWriteWorker;
+    qint64 writeQueued(qint64 maxBytes, std::vector<QByteArray>& batch);
+    qint64 copyQueued(char* dst, qint64 maxBytes) const;
+    void consumeQueued(qint64 bytes);
+    void clearQueue();
+    void performUringWrite();
+    bool submitUringWrite();
+
     QTimer* m_writeTimer;
+    FTDIWriteWorker* m_writeWorker;
+    quint64 m_run = 0;  // Counts PacedMode starts, so calls queued by a finished run are ignored
     double m_outputFrequency;  // Hz
     int m_bytesPerWrite;
-    QByteArray m_writeQueue;
+    WriteMode m_writeMode;
+    double m_targetRate;       // bytes/s, PacedMode only
+    scpThreadTuning m_threadTuning;
+    // Any thread may queue; only the writing thread (timer, pacing or I/O thread) consumes
+    mutable QMutex m_queueMutex;
+    std::deque<QByteArray> m_writeChunks;  // Shared, never copied on queue
+    int m_headOffset;                      // Bytes of the front chunk already written
+    std::atomic<qint64> m_queuedBytes;
+    std::vector<QByteArray> m_gatherBatch;  // Chunks referenced by the write in progress
     qint64 m_totalBytesWritten;
+
+    // PacedMode statistics, written by the pacing thread
+    std::atomic<double> m_pacedRate;
+    std::atomic<qint64> m_pacedBytes;
+    std::atomic<qint64> m_pacedElapsedNs;
+    std::atomic<qint64> m_pacedTicks;
+    std::atomic<qint64> m_pacedMissedTicks;
+    std::atomic<qint64> m_pacedJitterSumNs;
+    std::atomic<qint64> m_pacedJitterMaxNs;
+    QString m_lastWriteError;
+    bool m_useIoUring;
+    std::unique_ptr<scpUringFileWriter> m_uring;
+    bool m_useFraming;
+    scpFrameEncoder m_encoder;
+};
+
+// Worker thread that paces writes for scpFTDIWriter::PacedMode
+class FTDIWriteWorker : public QThread {
+    Q_OBJECT
+public:
+    explicit FTDIWriteWorker(scpFTDIWriter* parent);
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    scpFTDIWriter* m_parent;
+    std::atomic<bool> m_shouldStop{false};
 };
 
 #endif // SCPFTDIINTERFACE_H
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "scpFrameCodec.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define SCP_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define SCP_CRC32C_ARM 1
+#endif
+
+// ============================================================================
+// CRC-32C
+// ============================================================================
+
+namespace {
+
+constexpr quint32 kCrc32cPoly = 0x82F63B78u;  // Castagnoli, reflected
+
+struct Crc32cTable {
+    quint32 entries[256];
+    Crc32cTable() {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (c >> 1) ^ kCrc32cPoly : c >> 1;
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+quint32 crc32cSoftware(quint32 crc, const uchar* p, size_t length) {
+    static const Crc32cTable table;
+    while (length--) {
+        crc = table.entries[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(SCP_CRC32C_X86)
+__attribute__((target("sse4.2")))
+quint32 crc32cHardware(quint32 crc, const uchar* p, size_t length) {
+#if defined(__x86_64__)
+    quint64 c = crc;
+    while (length >= 8) {
+        quint64 v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+        p += 8;
+        length -= 8;
+    }
+    crc = static_cast<quint32>(c);
+#endif
+    while (length >= 4) {
+        quint32 v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        length -= 4;
+    }
+    while (length--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+bool detectHardware() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(SCP_CRC32C_ARM)
+quint32 crc32cHardware(quint32 crc, const uchar* p, size_t length) {
+    while (length >= 8) {
+        quint64 v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+        p += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+bool detectHardware() {
+    return true;  // Compiled for a CPU with the CRC32 extension
+}
+#endif
+
+}  // namespace
+
+bool scpCrc32cIsHardware() {
+#if defined(SCP_CRC32C_X86) || defined(SCP_CRC32C_ARM)
+    static const bool hardware = detectHardware();
+    return hardware;
+#else
+    return false;
+#endif
+}
+
+quint32 scpCrc32c(const void* data, size_t length, quint32 crc) {
+    const uchar* p = static_cast<const uchar*>(data);
+    crc = ~crc;
+#if defined(SCP_CRC32C_X86) || defined(SCP_CRC32C_ARM)
+    if (scpCrc32cIsHardware()) {
+        return ~crc32cHardware(crc, p, length);
+    }
+#endif
+    return ~crc32cSoftware(crc, p, length);
+}
+
+// ============================================================================
+// scpFrameEncoder
+// ============================================================================
+
+scpFrameEncoder::scpFrameEncoder(int maxPayload)
+    : m_maxPayload(scpFrame::kDefaultPayload) {
+    setMaxPayload(maxPayload);
+}
+
+void scpFrameEncoder::setMaxPayload(int bytes) {
+    m_maxPayload = std::clamp(bytes, 1, scpFrame::kMaxPayload);
+}
+
+QByteArray scpFrameEncoder::encode(const char* data, int length) {
+    QByteArray out;
+    if (!data || length <= 0) return out;
+
+    const int frames = (length + m_maxPayload - 1) / m_maxPayload;
+    out.resize(length + frames * scpFrame::kHeaderSize);
+    char* dst = out.data();
+
+    for (int offset = 0; offset < length; offset += m_maxPayload) {
+        const int n = std::min(m_maxPayload, length - offset);
+        qToLittleEndian<quint32>(scpFrame::kSync, dst);
+        qToLittleEndian<quint32>(m_sequence, dst + 4);
+        qToLittleEndian<quint32>(static_cast<quint32>(n), dst + 8);
+        memcpy(dst + scpFrame::kHeaderSize, data + offset, static_cast<size_t>(n));
+        // CRC covers sequence and length too, so a corrupted header is caught as well
+        quint32 crc = scpCrc32c(dst + 4, 8);
+        crc = scpCrc32c(dst + scpFrame::kHeaderSize, static_cast<size_t>(n), crc);
+        qToLittleEndian<quint32>(crc, dst + 12);
+
+        dst += scpFrame::kHeaderSize + n;
+        ++m_sequence;
+        ++m_framesEncoded;
+    }
+    return out;
+}
+
+// ============================================================================
+// scpFrameDecoder
+// ============================================================================
+
+void scpFrameDecoder::resync() {
+    m_buffer.clear();
+    m_pos = 0;
+    m_haveSequence = false;
+    m_expected = 0;
+}
+
+void scpFrameDecoder::reset() {
+    resync();
+    m_stats = Stats();
+}
+
+bool scpFrameDecoder::findSync() {
+    // Leaves m_pos on the next sync word; false keeps only a possible partial sync at the end
+    const uchar* base = reinterpret_cast<const uchar*>(m_buffer.constData());
+    const int size = m_buffer.size();
+    const uchar first = static_cast<uchar>(scpFrame::kSync & 0xFF);
+    int pos = m_pos;
+    while (pos + 4 <= size) {
+        const void* hit = memchr(base + pos, first, static_cast<size_t>(size - pos - 3));
+        if (!hit) {
+            pos = size - 3;
+            break;
+        }
+        pos = static_cast<int>(static_cast<const uchar*>(hit) - base);
+        if (qFromLittleEndian<quint32>(base + pos) == scpFrame::kSync) {
+            m_stats.bytesDiscarded += pos - m_pos;
+            m_pos = pos;
+            return true;
+        }
+        ++pos;
+    }
+    pos = std::max(m_pos, pos);
+    m_stats.bytesDiscarded += pos - m_pos;
+    m_pos = pos;
+    return false;
+}
+
+int scpFrameDecoder::decode(const char* input, int length, QByteArray& payload) {
+    if (input && length > 0) {
+        m_buffer.append(input, length);
+    }
+
+    int lost = 0;
+    for (;;) {
+        if (!findSync()) break;
+        if (m_buffer.size() - m_pos < scpFrame::kHeaderSize) break;
+
+        const uchar* header = reinterpret_cast<const uchar*>(m_buffer.constData()) + m_pos;
+        const quint32 sequence = qFromLittleEndian<quint32>(header + 4);
+        const quint32 len = qFromLittleEndian<quint32>(header + 8);
+        if (len > static_cast<quint32>(scpFrame::kMaxPayload)) {
+            // Not a real header (or a corrupted one): look for the next sync word
+            ++m_pos;
+            ++m_stats.bytesDiscarded;
+            continue;
+        }
+        const int frameSize = scpFrame::kHeaderSize + static_cast<int>(len);
+        if (m_buffer.size() - m_pos < frameSize) break;  // Wait for the rest
+
+        quint32 crc = scpCrc32c(header + 4, 8);
+        crc = scpCrc32c(header + scpFrame::kHeaderSize, len, crc);
+        if (crc != qFromLittleEndian<quint32>(header + 12)) {
+            // Resume the search inside this frame: a real sync may follow a damaged one
+            ++m_stats.crcErrors;
+            ++m_pos;
+            ++m_stats.bytesDiscarded;
+            continue;
+        }
+
+        if (m_haveSequence && sequence != m_expected) {
+            const quint32 gap = sequence - m_expected;
+            // A huge forward gap means the sender restarted; do not count it as loss
+            if (gap < 0x80000000u) {
+                lost += static_cast<int>(std::min<quint32>(gap, 0x7FFFFFFFu));
+            }
+        }
+        m_haveSequence = true;
+        m_expected = sequence + 1;
+
+        payload.append(reinterpret_cast<const char*>(header) + scpFrame::kHeaderSize,
+                       static_cast<int>(len));
+        m_stats.framesDecoded++;
+        m_stats.payloadBytes += len;
+        m_pos += frameSize;
+    }
+
+    // Compact once the consumed prefix dominates, keeping appends amortised O(1)
+    if (m_pos > 0 && m_pos >= m_buffer.size() / 2) {
+        m_buffer.remove(0, m_pos);
+        m_pos = 0;
+    }
+
+    m_stats.framesLost += lost;
+    return lost;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <QByteArray>
+#include <QtGlobal>
+#include <cstddef>
+
+/**
+ * @brief CRC-32C (Castagnoli) of a byte range
+ *
+ * Uses the SSE4.2 / ARMv8 CRC32 instructions when the CPU has them and a
+ * table-driven fallback otherwise. Pass a previous result as @p crc to
+ * continue a running checksum.
+ */
+quint32 scpCrc32c(const void* data, size_t length, quint32 crc = 0);
+bool scpCrc32cIsHardware();
+
+/**
+ * @brief Frame layout shared by scpFrameEncoder and scpFrameDecoder
+ *
+ * Every frame is a 16-byte little-endian header followed by the payload:
+ *
+ *   offset 0   sync     0x46504353 ("SCPF" on the wire)
+ *   offset 4   sequence increments by one per frame, wraps at 2^32
+ *   offset 8   length   payload bytes (<= kMaxPayload)
+ *   offset 12  crc      CRC-32C over sequence, length and payload
+ */
+namespace scpFrame {
+static constexpr quint32 kSync = 0x46504353u;
+static constexpr int kHeaderSize = 16;
+static constexpr int kMaxPayload = 64 * 1024;
+static constexpr int kDefaultPayload = 1024;
+}
+
+/**
+ * @brief Splits a byte stream into sequenced, checksummed frames
+ */
+class scpFrameEncoder {
+public:
+    explicit scpFrameEncoder(int maxPayload = scpFrame::kDefaultPayload);
+
+    // Largest payload per frame; longer input is split across frames
+    void setMaxPayload(int bytes);
+    int maxPayload() const { return m_maxPayload; }
+
+    // Frames @p data, appending one or more complete frames to the result
+    QByteArray encode(const char* data, int length);
+    QByteArray encode(const QByteArray& data) { return encode(data.constData(), data.size()); }
+
+    // Restart numbering at zero (e.g. when the link is reopened)
+    void reset() { m_sequence = 0; }
+    quint32 nextSequence() const { return m_sequence; }
+    qint64 framesEncoded() const { return m_framesEncoded; }
+
+private:
+    int m_maxPayload;
+    quint32 m_sequence = 0;
+    qint64 m_framesEncoded = 0;
+};
+
+/**
+ * @brief Recovers payloads from a framed byte stream
+ *
+ * Input may arrive in arbitrary pieces; partial frames are kept until the
+ * rest arrives. A header whose length is out of range, or a frame whose
+ * CRC does not match, is skipped by searching for the next sync word one
+ * byte further on, so a corrupted or truncated frame costs that frame and
+ * nothing after it. Gaps in the sequence numbers are counted as lost
+ * frames (corrupted frames show up there as well).
+ */
+class scpFrameDecoder {
+public:
+    struct Stats {
+        qint64 framesDecoded = 0;
+        qint64 framesLost = 0;       // Sequence gaps, including dropped corrupt frames
+        qint64 crcErrors = 0;
+        qint64 bytesDiscarded = 0;   // Skipped while searching for sync
+        qint64 payloadBytes = 0;
+    };
+
+    scpFrameDecoder() = default;
+
+    /**
+     * Appends the payloads of all complete frames in @p input to @p payload.
+     * @return number of frames found missing while decoding this input
+     */
+    int decode(const char* input, int length, QByteArray& payload);
+    int decode(const QByteArray& input, QByteArray& payload) {
+        return decode(input.constData(), input.size(), payload);
+    }
+
+    // Forget buffered bytes and the expected sequence; statistics are kept
+    void resync();
+    // resync() and clear statistics
+    void reset();
+
+    const Stats& stats() const { return m_stats; }
+    int bufferedBytes() const { return m_buffer.size() - m_pos; }
+
+private:
+    bool findSync();
+
+    QByteArray m_buffer;
+    int m_pos = 0;
+    bool m_haveSequence = false;
+    quint32 m_expected = 0;
+    Stats m_stats;
+};
@@ -1,15 +1,32 @@
 #include "scpFtdiSource.h"
+#include "scpThroughputMonitor.h"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+
+// Upper bound for one queued read, and the blocking read used when the queue is empty
+static constexpr DWORD kMaxReadBytes = 64 * 1024;
+static constexpr DWORD kIdleReadBytes = 64;
+// Below this much queued data, wait briefly once so reads come in batches
+static constexpr DWORD kBatchReadBytes = 4096;
+static constexpr int kBatchWaitUs = 500;
+static constexpr UCHAR kLatencyTimerMs = 2;
+// Short read timeout so the ingest thread notices stop() promptly
+static constexpr ULONG kReadTimeoutMs = 100;
+static constexpr ULONG kWriteTimeoutMs = 5000;
 
 scpFtdiSource::scpFtdiSource(const std::string& serial, size_t bufferSize)
     : handle_(nullptr), serial_(serial), bufferSize_(bufferSize),
-      buffer_(bufferSize, 0.0f), running_(false),
-      sampleRate_(1000), freq_(10.0), amp_(1.0f), phase_(0.0)
+      running_(false), sampleRate_(1000),
+      ringCapacity_(64 * 1024), ringHead_(0), ringFilled_(0),
+      bytesRead_(0), readErrors_(0),
+      depth_(3), filled_(0), writeIndex_(0),
+      underruns_(0), writeErrors_(0),
+      freq_(10.0), amp_(1.0f), phase_(0.0)
 {}
 
 scpFtdiSource::~scpFtdiSource() {
     stop();
-    if (handle_) FT_Close(handle_);
 }
 
 bool scpFtdiSource::start() {
@@ -22,18 +39,50 @@ bool scpFtdiSource::start() {
         return false;
     }
 
-    FT_SetLatencyTimer(handle_, 2);
-    FT_SetTimeouts(handle_, 5000, 5000);
+    FT_SetLatencyTimer(handle_, kLatencyTimerMs);
+    FT_SetTimeouts(handle_, kReadTimeoutMs, kWriteTimeoutMs);
     FT_SetBitMode(handle_, 0xFF, 0x40); // synchronous FIFO
 
+    slots_.assign(depth_, Slot{std::vector<float>(bufferSize_), std::vector<uint8_t>(bufferSize_)});
+    filled_ = 0;
+    writeIndex_ = 0;
+    underruns_ = 0;
+    writeErrors_ = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(bufMutex_);
+        ring_.assign(ringCapacity_, 0.0f);
+        ringHead_ = 0;
+        ringFilled_ = 0;
+    }
+    bytesRead_ = 0;
+    readErrors_ = 0;
+
     running_ = true;
-    worker_ = std::thread(&scpFtdiSource::runLoop, this);
+    reader_ = std::thread(&scpFtdiSource::readLoop, this);
+    writer_ = std::thread(&scpFtdiSource::writeLoop, this);
+    generator_ = std::thread(&scpFtdiSource::generateLoop, this);
+    emit stateChanged(true);
     return true;
 }
 
 void scpFtdiSource::stop() {
-    running_ = false;
-    if (worker_.joinable()) worker_.join();
+    bool wasRunning;
+    {
+        std::lock_guard<std::mutex> lock(pipeMutex_);
+        wasRunning = running_.exchange(false);
+    }
+    if (!wasRunning) return;
+    slotFree_.notify_all();
+    slotFilled_.notify_all();
+    if (generator_.joinable()) generator_.join();
+    if (writer_.joinable()) writer_.join();
+    if (reader_.joinable()) reader_.join();  // Returns within the read timeout
+
+    // start() opens the device again
+    FT_Close(handle_);
+    handle_ = nullptr;
+    emit stateChanged(false);
 }
 
 bool scpFtdiSource::isActive() const { return running_; }
@@ -42,10 +91,17 @@ int scpFtdiSource::sampleRate() const { return sampleRate_; }
 
 int scpFtdiSource::copyRecentSamples(int count, QVector<float>& out) {
     std::lock_guard<std::mutex> lock(bufMutex_);
-    count = std::min(count, (int)buffer_.size());
-    out.resize(count);
-    for (int i = 0; i < count; ++i) out[i] = buffer_[i];
-    return count;
+    const size_t n = std::min<size_t>(std::max(count, 0), ringFilled_);
+    out.resize(static_cast<int>(n));
+    if (n == 0) return 0;
+
+    // Newest n samples end at ringHead_; copy them oldest first, in at most two pieces
+    const size_t cap = ring_.size();
+    const size_t start = (ringHead_ + cap - n) % cap;
+    const size_t first = std::min(n, cap - start);
+    memcpy(out.data(), ring_.data() + start, first * sizeof(float));
+    memcpy(out.data() + first, ring_.data(), (n - first) * sizeof(float));
+    return static_cast<int>(n);
 }
 
 void scpFtdiSource::sendText(const std::string& text) {
@@ -57,27 +113,142 @@ void scpFtdiSource::sendText(const std::string& text) {
 void scpFtdiSource::setSignalFrequency(double hz) { freq_ = hz; }
 void scpFtdiSource::setSignalAmplitude(float amp) { amp_ = amp; }
 
-void scpFtdiSource::runLoop() {
-    const double dt = 1.0 / sampleRate_;
-    std::vector<uint8_t> rawBuffer(bufferSize_);
+void scpFtdiSource::setPipelineDepth(size_t depth) {
+    if (running_) return;
+    depth_ = std::clamp<size_t>(depth, 2, 4);
+}
+
+void scpFtdiSource::setRingCapacity(size_t samples) {
+    if (running_) return;
+    ringCapacity_ = std::max<size_t>(samples, 1024);
+}
+
+void scpFtdiSource::appendSamples(const float* data, size_t count) {
+    std::lock_guard<std::mutex> lock(bufMutex_);
+    const size_t cap = ring_.size();
+    if (count > cap) {
+        // Only the newest cap samples can survive
+        data += count - cap;
+        count = cap;
+    }
+    const size_t first = std::min(count, cap - ringHead_);
+    memcpy(ring_.data() + ringHead_, data, first * sizeof(float));
+    memcpy(ring_.data(), data + first, (count - first) * sizeof(float));
+    ringHead_ = (ringHead_ + count) % cap;
+    ringFilled_ = std::min(cap, ringFilled_ + count);
+}
+
+void scpFtdiSource::readLoop() {
+    std::vector<uint8_t> raw(kMaxReadBytes);
+    std::vector<float> samples(kMaxReadBytes);
+    bool batchWaited = false;
 
     while (running_) {
+        // Size each read from what the driver already holds: one call drains the queue
+        DWORD queued = 0;
+        if (FT_GetQueueStatus(handle_, &queued) != FT_OK) {
+            readErrors_.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        if (queued > 0 && queued < kBatchReadBytes && !batchWaited) {
+            // A trickle: let more arrive rather than spinning on tiny reads
+            batchWaited = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(kBatchWaitUs));
+            continue;
+        }
+        batchWaited = false;
+        // Nothing queued: a small read blocks until data arrives or the read timeout passes
+        const DWORD toRead = queued > 0 ? std::min(queued, kMaxReadBytes) : kIdleReadBytes;
+
+        DWORD got = 0;
+        if (FT_Read(handle_, raw.data(), toRead, &got) != FT_OK) {
+            readErrors_.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        if (got == 0) continue;
+        const qint64 readNs = scpMonotonicNs();
+
+        // Inverse of the byte mapping used for the test signal
+        const float amp = amp_.load(std::memory_order_relaxed);
+        const float scale = amp / 127.0f;
+        for (DWORD i = 0; i < got; ++i) {
+            samples[i] = raw[i] * scale - amp;
+        }
+        appendSamples(samples.data(), got);
+        stampSamples(readNs, static_cast<int>(got));
+        bytesRead_.fetch_add(got, std::memory_order_relaxed);
+        if (throughputMonitor()) throughputMonitor()->recordBytesRead(static_cast<int>(got));
+    }
+}
+
+void scpFtdiSource::fillSlot(Slot& slot) {
+    // Runs without any lock: the slot belongs to the generator until it is published
+    const double dt = 1.0 / sampleRate_;
+    const double step = 2.0 * M_PI * freq_.load(std::memory_order_relaxed) * dt;
+    const float amp = amp_.load(std::memory_order_relaxed);
+    const float scale = amp != 0.0f ? 127.0f / amp : 0.0f;
+
+    for (size_t i = 0; i < slot.samples.size(); ++i) {
+        const float v = amp * static_cast<float>(std::sin(phase_)); // sine wave
+        slot.samples[i] = v;
+        slot.raw[i] = static_cast<uint8_t>((v + amp) * scale); // 0-255
+        phase_ += step;
+        if (phase_ > 2.0 * M_PI) phase_ -= 2.0 * M_PI;
+    }
+}
+
+void scpFtdiSource::generateLoop() {
+    size_t fillIndex = 0;
+    for (;;) {
+        {
+            // Wait until the writer has released the slot we are about to refill
+            std::unique_lock<std::mutex> lock(pipeMutex_);
+            slotFree_.wait(lock, [this] { return !running_ || filled_ < slots_.size(); });
+            if (!running_) return;
+        }
+
+        fillSlot(slots_[fillIndex]);
+        fillIndex = (fillIndex + 1) % slots_.size();
+
         {
-            std::lock_guard<std::mutex> lock(bufMutex_);
-            for (size_t i = 0; i < buffer_.size(); ++i) {
-                buffer_[i] = amp_ * std::sin(phase_); // sine wave
-                rawBuffer[i] = static_cast<uint8_t>((buffer_[i] + amp_) * 127.0f / amp_); // 0-255
-                phase_ += 2.0 * M_PI * freq_ * dt;
-                if (phase_ > 2.0 * M_PI) phase_ -= 2.0 * M_PI;
+            std::lock_guard<std::mutex> lock(pipeMutex_);
+            ++filled_;
+        }
+        slotFilled_.notify_one();
+    }
+}
+
+void scpFtdiSource::writeLoop() {
+    bool primed = false;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pipeMutex_);
+            // An empty pipeline after the first buffer means a gap in the stream
+            if (primed && filled_ == 0 && running_) {
+                underruns_.fetch_add(1, std::memory_order_relaxed);
             }
+            slotFilled_.wait(lock, [this] { return !running_ || filled_ > 0; });
+            if (!running_) return;
         }
 
-        // Write raw bytes to FTDI
-        if (handle_) {
-            DWORD bytesWritten = 0;
-            FT_Write(handle_, rawBuffer.data(), (DWORD)rawBuffer.size(), &bytesWritten);
+        Slot& slot = slots_[writeIndex_];
+
+        // In synchronous FIFO mode FT_Write blocks until the device has taken the data,
+        // which paces the stream; the generator is meanwhile filling the next slot
+        DWORD bytesWritten = 0;
+        const FT_STATUS status = FT_Write(handle_, slot.raw.data(), (DWORD)slot.raw.size(), &bytesWritten);
+        if (status != FT_OK || bytesWritten != slot.raw.size()) {
+            writeErrors_.fetch_add(1, std::memory_order_relaxed);
         }
+        primed = true;
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        writeIndex_ = (writeIndex_ + 1) % slots_.size();
+        {
+            std::lock_guard<std::mutex> lock(pipeMutex_);
+            --filled_;
+        }
+        slotFree_.notify_one();
     }
 }
@@ -7,14 +7,33 @@
 #include <string>
 #include <iostream>
 #include <mutex>
+#include <condition_variable>
 #include <cmath>
 
+/**
+ * FTDI device source: acquires bytes from the device and streams a test signal to it.
+ *
+ * Acquisition runs on its own ingest thread. Each FT_Read is sized from
+ * FT_GetQueueStatus, so it drains whatever the driver already holds in one
+ * call. If nothing is queued, a small read waits up to the read timeout.
+ * Bytes are converted to samples and appended to a ring buffer, and
+ * copyRecentSamples returns the newest ones, oldest first.
+ *
+ * Output runs on a two-stage pipeline. A generator thread fills the next
+ * of several pre-allocated buffers (double or triple buffering) while a
+ * writer thread hands the previous one to FT_Write. Signal generation and
+ * USB transfers overlap, and no lock is held across either. In synchronous
+ * FIFO mode the writes are issued back to back and paced by the device.
+ *
+ * Only portable D2XX calls are used, so the class also builds against
+ * the Linux D2XX library.
+ */
 class scpFtdiSource : public scpDataSource {
 public:
     scpFtdiSource(const std::string& serial, size_t bufferSize = 256);
     ~scpFtdiSource() override;
 
-    // Start/stop acquisition
+    // Start/stop acquisition; the device is open only in between
     bool start() override;
     void stop() override;
 
@@ -30,20 +49,64 @@ public:
     void setSignalFrequency(double hz);  // sine wave frequency
     void setSignalAmplitude(float amp);  // sine wave amplitude
 
+    // Number of pipeline buffers, 2 (double) to 4; takes effect on next start()
+    void setPipelineDepth(size_t depth);
+    size_t pipelineDepth() const { return depth_; }
+
+    // Acquired samples kept for copyRecentSamples; takes effect on next start()
+    void setRingCapacity(size_t samples);
+    size_t ringCapacity() const { return ringCapacity_; }
+
+    uint64_t bytesRead() const { return bytesRead_.load(std::memory_order_relaxed); }
+    uint64_t readErrors() const { return readErrors_.load(std::memory_order_relaxed); }
+
+    // Times the writer found no buffer ready and the stream had a gap
+    uint64_t underruns() const { return underruns_.load(std::memory_order_relaxed); }
+    uint64_t writeErrors() const { return writeErrors_.load(std::memory_order_relaxed); }
+
 private:
-    void runLoop();
+    struct Slot {
+        std::vector<float> samples;
+        std::vector<uint8_t> raw;
+    };
+
+    void generateLoop();
+    void writeLoop();
+    void readLoop();
+    void fillSlot(Slot& slot);
+    void appendSamples(const float* data, size_t count);
 
     FT_HANDLE handle_;
     std::string serial_;
     size_t bufferSize_;
-    std::vector<float> buffer_;
-    std::thread worker_;
     std::atomic<bool> running_;
     int sampleRate_; // store user-defined sample rate
+
+    // Acquisition ring, guarded by bufMutex_ (held only to copy in or out)
     std::mutex bufMutex_;
+    size_t ringCapacity_;
+    std::vector<float> ring_;
+    size_t ringHead_;            // Next write position
+    size_t ringFilled_;          // Valid samples, up to ringCapacity_
+    std::thread reader_;
+    std::atomic<uint64_t> bytesRead_;
+    std::atomic<uint64_t> readErrors_;
+
+    // Pipeline: slots cycle generator -> writer -> generator in order
+    size_t depth_;
+    std::vector<Slot> slots_;
+    size_t filled_;              // Slots generated but not yet written
+    size_t writeIndex_;          // Next slot the writer sends
+    std::mutex pipeMutex_;
+    std::condition_variable slotFree_;
+    std::condition_variable slotFilled_;
+    std::thread generator_;
+    std::thread writer_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> writeErrors_;
 
     // Test signal generation
-    double freq_;    // Hz
-    float amp_;      // amplitude
-    double phase_;   // internal phase for sine wave
+    std::atomic<double> freq_;   // Hz
+    std::atomic<float> amp_;     // amplitude
+    double phase_;   // internal phase for sine wave, generator thread only
 };
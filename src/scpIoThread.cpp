@@ -0,0 +1,91 @@
+#include "scpIoThread.h"
+#include "scpTrace.h"
+#include <QStringList>
+#include <algorithm>
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+QString scpThreadTuning::toString() const {
+    QStringList parts;
+    if (cpu >= 0) parts << QString("cpu %1").arg(cpu);
+    if (realtimePriority > 0) parts << QString("realtime priority %1").arg(realtimePriority);
+    return parts.isEmpty() ? QString("default scheduling") : parts.join(", ");
+}
+
+bool scpApplyThreadTuning(const scpThreadTuning& tuning, QString* message) {
+    QStringList applied;
+    QStringList failed;
+
+#ifdef Q_OS_LINUX
+    if (tuning.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(tuning.cpu, &set);
+        const int rc = tuning.cpu < CPU_SETSIZE
+            ? pthread_setaffinity_np(pthread_self(), sizeof(set), &set) : EINVAL;
+        if (rc == 0) applied << QString("pinned to cpu %1").arg(tuning.cpu);
+        else failed << QString("cpu %1: %2").arg(tuning.cpu).arg(strerror(rc));
+    }
+    if (tuning.realtimePriority > 0) {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = std::clamp(tuning.realtimePriority,
+                                          sched_get_priority_min(SCHED_FIFO),
+                                          sched_get_priority_max(SCHED_FIFO));
+        const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc == 0) applied << QString("SCHED_FIFO priority %1").arg(param.sched_priority);
+        else failed << QString("SCHED_FIFO: %1").arg(strerror(rc));
+    }
+#elif defined(Q_OS_WIN)
+    if (tuning.cpu >= 0) {
+        const bool ok = tuning.cpu < static_cast<int>(sizeof(DWORD_PTR) * 8) &&
+                        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << tuning.cpu) != 0;
+        if (ok) applied << QString("pinned to cpu %1").arg(tuning.cpu);
+        else failed << QString("cpu %1: error %2").arg(tuning.cpu).arg(GetLastError());
+    }
+    if (tuning.realtimePriority > 0) {
+        if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            applied << "time-critical priority";
+        } else {
+            failed << QString("priority: error %1").arg(GetLastError());
+        }
+    }
+#else
+    if (!tuning.isDefault()) failed << "thread tuning not supported on this platform";
+#endif
+
+    if (message) {
+        *message = failed.isEmpty()
+            ? (applied.isEmpty() ? QString("default scheduling") : applied.join(", "))
+            : QString("could not apply %1").arg(failed.join("; "));
+    }
+    return failed.isEmpty();
+}
+
+scpIoThread::scpIoThread(const QString& name, const scpThreadTuning& tuning, QObject* parent)
+    : QThread(parent)
+    , m_tuning(tuning)
+{
+    setObjectName(name);
+}
+
+scpIoThread::~scpIoThread() {
+    quit();
+    wait();
+}
+
+void scpIoThread::run() {
+    SCP_TRACE_THREAD_NAME(objectName().toUtf8().constData());
+    if (!m_tuning.isDefault()) {
+        QString message;
+        scpApplyThreadTuning(m_tuning, &message);
+        emit statusChanged(QString("%1 thread: %2").arg(objectName(), message));
+    }
+    exec();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <QThread>
+#include <QString>
+
+/**
+ * @brief Scheduling options for a thread that services USB I/O
+ *
+ * cpu pins the thread to one logical CPU (-1 leaves it to the scheduler).
+ * realtimePriority > 0 requests SCHED_FIFO at that priority on Linux
+ * (needs CAP_SYS_NICE or an rtprio limit) and time-critical priority on
+ * Windows. Anything that cannot be applied is reported, not fatal.
+ */
+struct scpThreadTuning {
+    int cpu = -1;
+    int realtimePriority = 0;
+
+    bool isDefault() const { return cpu < 0 && realtimePriority <= 0; }
+    QString toString() const;
+};
+
+/**
+ * @brief Applies @p tuning to the calling thread
+ *
+ * Returns false if any part could not be applied; @p message (optional)
+ * then says what failed, otherwise what was applied.
+ */
+bool scpApplyThreadTuning(const scpThreadTuning& tuning, QString* message = nullptr);
+
+/**
+ * @brief Event-loop thread for a controller's reader or writer
+ *
+ * Applies its scpThreadTuning when it starts and then runs an ordinary
+ * event loop, so the QTimers of the objects moved onto it keep working
+ * independently of the GUI thread. The outcome of the tuning is reported
+ * through statusChanged.
+ */
+class scpIoThread : public QThread {
+    Q_OBJECT
+
+public:
+    explicit scpIoThread(const QString& name, const scpThreadTuning& tuning = scpThreadTuning(),
+                         QObject* parent = nullptr);
+    ~scpIoThread() override;
+
+    scpThreadTuning tuning() const { return m_tuning; }
+
+signals:
+    void statusChanged(const QString& status);
+
+protected:
+    void run() override;
+
+private:
+    scpThreadTuning m_tuning;
+};
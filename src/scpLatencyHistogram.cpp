@@ -0,0 +1,102 @@
+#include "scpLatencyHistogram.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+static void raiseMax(std::atomic<qint64>& target, qint64 value) {
+    qint64 current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+scpLatencyHistogram::scpLatencyHistogram() {
+    for (std::atomic<quint64>& c : m_counts) c.store(0, std::memory_order_relaxed);
+}
+
+int scpLatencyHistogram::bucketIndex(qint64 value) {
+    if (value < kSubBuckets) return value < 0 ? 0 : static_cast<int>(value);
+    // Octave from the top bit, sub-bucket from the next kSubBucketBits bits
+    const int msb = 63 - qCountLeadingZeroBits(static_cast<quint64>(value));
+    if (msb >= kMaxValueBits) return kBucketCount - 1;
+    const int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+}
+
+qint64 scpLatencyHistogram::bucketUpperBound(int index) {
+    if (index < kSubBuckets) return index;
+    const int shift = index / kSubBuckets - 1;
+    const qint64 lowest = static_cast<qint64>(index % kSubBuckets + kSubBuckets) << shift;
+    return lowest + (qint64(1) << shift) - 1;
+}
+
+void scpLatencyHistogram::record(qint64 microseconds) {
+    const qint64 value = std::max<qint64>(0, microseconds);
+    m_counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    raiseMax(m_max, value);
+    raiseMax(m_intervalMax, value);
+}
+
+scpLatencyHistogram::Snapshot scpLatencyHistogram::snapshot() const {
+    // Not atomic as a whole: samples recorded meanwhile may be partly included
+    Snapshot snap;
+    snap.counts.resize(kBucketCount);
+    quint64 total = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        snap.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        total += snap.counts[i];
+    }
+    snap.count = total;
+    snap.sum = m_sum.load(std::memory_order_relaxed);
+    snap.max = m_max.load(std::memory_order_relaxed);
+    return snap;
+}
+
+qint64 scpLatencyHistogram::takeIntervalMax() {
+    return m_intervalMax.exchange(0, std::memory_order_relaxed);
+}
+
+void scpLatencyHistogram::reset() {
+    for (std::atomic<quint64>& c : m_counts) c.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+    m_intervalMax.store(0, std::memory_order_relaxed);
+}
+
+qint64 scpLatencyHistogram::Snapshot::valueAtPercentile(double q) const {
+    if (count == 0 || counts.empty()) return 0;
+    // Rank of the sample that covers fraction q, 1-based
+    const quint64 rank = std::max<quint64>(1, static_cast<quint64>(q * count + 0.5));
+    quint64 seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucketUpperBound(static_cast<int>(i)), max);
+    }
+    return max;
+}
+
+scpLatencyHistogram::Summary scpLatencyHistogram::Snapshot::summary() const {
+    Summary s;
+    s.count = count;
+    if (count == 0) return s;
+    s.mean = static_cast<double>(sum) / count;
+    s.p50 = valueAtPercentile(0.50);
+    s.p90 = valueAtPercentile(0.90);
+    s.p99 = valueAtPercentile(0.99);
+    s.p999 = valueAtPercentile(0.999);
+    s.max = max;
+    return s;
+}
+
+scpLatencyHistogram::Snapshot scpLatencyHistogram::Snapshot::since(const Snapshot& earlier) const {
+    Snapshot diff;
+    diff.counts.resize(counts.size());
+    for (size_t i = 0; i < counts.size(); ++i) {
+        const quint64 before = i < earlier.counts.size() ? earlier.counts[i] : 0;
+        diff.counts[i] = counts[i] >= before ? counts[i] - before : 0;
+        diff.count += diff.counts[i];
+    }
+    diff.sum = std::max<qint64>(0, sum - earlier.sum);
+    diff.max = max;
+    return diff;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Monotonic clock (ns) shared by the latency stamps of the whole pipeline
+inline qint64 scpMonotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Lock-free log-bucketed (HDR-style) histogram of latencies in microseconds
+ *
+ * Every power-of-two range is split into 32 linear sub-buckets, so a
+ * recorded value is known to within ~3% from 1 us up to 2^36 us (~19 h);
+ * larger values land in the top bucket. record() is a relaxed fetch_add on
+ * one bucket plus the count, sum and max, so any number of threads can
+ * record without a lock.
+ *
+ * Percentiles are taken from a Snapshot. Subtracting an earlier snapshot
+ * of the same histogram gives the distribution of just that interval;
+ * takeIntervalMax() returns the exact maximum since its previous call.
+ */
+class scpLatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxValueBits = 36;
+    static constexpr int kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+    // Percentiles (us) of a set of samples; 0 when it is empty
+    struct Summary {
+        quint64 count = 0;
+        double mean = 0.0;
+        qint64 p50 = 0;
+        qint64 p90 = 0;
+        qint64 p99 = 0;
+        qint64 p999 = 0;
+        qint64 max = 0;
+    };
+
+    struct Snapshot {
+        std::vector<quint64> counts;   // Per bucket
+        quint64 count = 0;
+        qint64 sum = 0;
+        qint64 max = 0;
+
+        // Value at or below which fraction q (0..1] of the samples fall (bucket upper bound, <= max)
+        qint64 valueAtPercentile(double q) const;
+        Summary summary() const;
+        // Samples recorded after @p earlier; max is unknown and left as the later one's
+        Snapshot since(const Snapshot& earlier) const;
+    };
+
+    scpLatencyHistogram();
+
+    void record(qint64 microseconds);
+    Snapshot snapshot() const;
+    qint64 takeIntervalMax();
+    void reset();
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<quint64>, kBucketCount> m_counts;
+    std::atomic<qint64> m_sum{0};
+    std::atomic<qint64> m_max{0};
+    std::atomic<qint64> m_intervalMax{0};
+};
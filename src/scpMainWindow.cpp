@@ -1,8 +1,12 @@
 #include "scpMainWindow.h"
+#include "scpThroughputMonitor.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QStatusBar>
 #include <QLabel>
+#include <QFileDialog>
+#include <QTimer>
+#include <QFontDatabase>
 
 static const struct { const char* label; double sec; } kTimebases[] = {
     {"5 ms/div", 0.005}, {"10 ms/div", 0.010}, {"20 ms/div", 0.020},
@@ -21,6 +25,7 @@ scpMainWindow::scpMainWindow(QWidget* parent)
 }
 
 scpMainWindow::~scpMainWindow() {
+    if (m_recorder) m_recorder->stop();
     if (m_audio) m_audio->stop();
     if (m_gen) m_gen->stop();
     if (m_simGen) m_simGen->stop();
@@ -55,6 +60,13 @@ void scpMainWindow::buildUi() {
     m_startStop = new QPushButton("Start", firstRow);
     connect(m_startStop, &QPushButton::clicked, this, &scpMainWindow::onStartStop);
 
+    m_recordBtn = new QPushButton("Record", firstRow);
+    connect(m_recordBtn, &QPushButton::clicked, this, &scpMainWindow::onRecord);
+
+    m_perfBtn = new QPushButton("Stats", firstRow);
+    m_perfBtn->setCheckable(true);
+    m_perfBtn->setEnabled(false);  // Until a monitor is set
+
     m_timebaseCombo = new QComboBox(firstRow);
     for (auto t : kTimebases) m_timebaseCombo->addItem(t.label);
     m_timebaseCombo->setCurrentIndex(3); // default 50 ms/div
@@ -100,6 +112,8 @@ void scpMainWindow::buildUi() {
     hl1->addWidget(new QLabel("Source:", firstRow));
     hl1->addWidget(m_sourceCombo);
     hl1->addWidget(m_startStop);
+    hl1->addWidget(m_recordBtn);
+    hl1->addWidget(m_perfBtn);
     hl1->addSpacing(12);
     hl1->addWidget(new QLabel("Timebase:", firstRow));
     hl1->addWidget(m_timebaseCombo);
@@ -144,9 +158,18 @@ void scpMainWindow::buildUi() {
     // Initially hide message row (show only when Message Waveform is selected)
     secondRow->setVisible(false);
 
-    // Add both rows to main layout
+    // Stats panel, filled from the throughput monitor's updates
+    m_perfPanel = new QLabel(m_controls);
+    m_perfPanel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_perfPanel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_perfPanel->setFrameStyle(QFrame::StyledPanel);
+    m_perfPanel->setVisible(false);
+    connect(m_perfBtn, &QPushButton::toggled, m_perfPanel, &QLabel::setVisible);
+
+    // Add all rows to main layout
     mainLayout->addWidget(firstRow);
     mainLayout->addWidget(secondRow);
+    mainLayout->addWidget(m_perfPanel);
 
     // Store secondRow as a member for show/hide (using dynamic property)
     m_controls->setProperty("messageRow", QVariant::fromValue(secondRow));
@@ -179,10 +202,20 @@ void scpMainWindow::buildUi() {
     m_msgLabel = new QLabel(this);
     m_msgLabel->setStyleSheet("color: blue; font-weight: bold;");
     statusBar()->addWidget(m_msgLabel);
+
+    // Recorder
+    m_recorder = new scpStreamRecorder(this);
+    connect(m_recorder, &scpStreamRecorder::errorOccurred, this, [this](const QString& error) {
+        m_status->setText(error);
+    });
+    m_recordTimer = new QTimer(this);
+    m_recordTimer->setInterval(500);
+    connect(m_recordTimer, &QTimer::timeout, this, &scpMainWindow::updateRecordStatus);
 }
 
 void scpMainWindow::onSourceChanged(int idx) {
     if (m_running) onStartStop(); // stop current
+    if (m_recorder->isRecording()) onRecord(); // a recording follows one source
     
     // Show/hide message input based on source
     QWidget* messageRow = m_controls->property("messageRow").value<QWidget*>();
@@ -246,6 +279,69 @@ void scpMainWindow::onStartStop() {
     }
 }
 
+void scpMainWindow::onRecord() {
+    if (m_recorder->isRecording()) {
+        m_recordTimer->stop();
+        m_recorder->stop();
+        const scpStreamRecorder::Stats st = m_recorder->stats();
+        m_recordBtn->setText("Record");
+        m_status->setText(QString("Recorded %1 samples (%2 dropped)")
+                          .arg(st.samplesWritten).arg(st.droppedSamples));
+        return;
+    }
+
+    if (!m_current) return;
+    const QString path = QFileDialog::getSaveFileName(this, "Record to file", "recording.f32",
+                                                      "Raw float32 (*.f32);;All files (*)");
+    if (path.isEmpty()) return;
+
+    if (m_recorder->start(m_current, path)) {
+        m_recordBtn->setText("Stop Rec");
+        m_recordTimer->start();
+        updateRecordStatus();
+    }
+}
+
+void scpMainWindow::updateRecordStatus() {
+    if (!m_recorder->isRecording()) return;
+    const scpStreamRecorder::Stats st = m_recorder->stats();
+    m_status->setText(QString("REC %1 samples | write %2 ms avg, %3 ms max | %4 dropped")
+                      .arg(st.samplesWritten).arg(st.avgWriteMs, 0, 'f', 2)
+                      .arg(st.maxWriteMs, 0, 'f', 2).arg(st.droppedSamples));
+}
+
+void scpMainWindow::setThroughputMonitor(scpThroughputMonitor* monitor) {
+    if (m_monitor) disconnect(m_monitor, nullptr, this, nullptr);
+    m_monitor = monitor;
+
+    scpDataSource* sources[] = {m_audio, m_gen, m_simGen, m_simAcq, m_msgSource};
+    for (scpDataSource* source : sources) {
+        if (source) source->setThroughputMonitor(monitor);
+    }
+    m_view->setThroughputMonitor(monitor);
+
+    m_perfBtn->setEnabled(monitor != nullptr);
+    m_perfBtn->setChecked(monitor != nullptr);
+    if (!monitor) return;
+    connect(monitor, &scpThroughputMonitor::statisticsUpdated, this, &scpMainWindow::updatePerfPanel);
+    m_lastFrameTimes = m_view->frameTimes().snapshot();
+    updatePerfPanel(monitor->getStatisticsString());
+}
+
+void scpMainWindow::updatePerfPanel(const QString& stats) {
+    // Paint time of this view over the same interval, next to the pipeline figures
+    const scpLatencyHistogram::Snapshot frames = m_view->frameTimes().snapshot();
+    const scpLatencyHistogram::Summary paint = frames.since(m_lastFrameTimes).summary();
+    m_lastFrameTimes = frames;
+
+    QString text = stats.trimmed();
+    if (paint.count > 0) {
+        text += QString("\nPaint: p50 %1  p99 %2  max %3 μs  (%4 frames)")
+                .arg(paint.p50).arg(paint.p99).arg(paint.max).arg(paint.count);
+    }
+    m_perfPanel->setText(text);
+}
+
 void scpMainWindow::onTimebaseChanged(int idx) {
     if (idx < 0) return;
     // total window seconds = sec/per_div * 10 divisions
@@ -307,6 +403,7 @@ void scpMainWindow::onSendMessage() {
 
 void scpMainWindow::setSource(scpDataSource* source) {
     if (!source) return;
+    if (m_recorder && m_recorder->isRecording() && m_recorder->source() != source) onRecord();
     m_current = source;
     m_view->setSource(source);
 }
@@ -12,6 +12,10 @@
 #include "scpSimulatedGeneratorSource.h"
 #include "scpSimulatedAcquisitionSource.h"
 #include "scpDataSource.h"
+#include "scpStreamRecorder.h"
+#include "scpLatencyHistogram.h"
+
+class scpThroughputMonitor;
 
 class scpMainWindow : public QMainWindow {
     Q_OBJECT
@@ -25,6 +29,11 @@ public:
     // Show message in GUI
     void showMessage(const QString& message);
 
+    scpScopeView* scopeView() const { return m_view; }
+
+    // App-wide monitor: fed by the built-in sources and the scope view, shown in the stats panel
+    void setThroughputMonitor(scpThroughputMonitor* monitor);
+
 private slots:
     void onSourceChanged(int idx);
     void onStartStop();
@@ -35,6 +44,9 @@ private slots:
     void onGenAmplitudeChanged(double amp);
     void onGenOffsetChanged(double offset);
     void onSendMessage();  // NEW: handle send button
+    void onRecord();
+    void updateRecordStatus();
+    void updatePerfPanel(const QString& stats);
 
 private:
     void buildUi();
@@ -54,6 +66,13 @@ private:
     QLabel* m_msgLabel = nullptr;     // Message label for command-line messages
     QLineEdit* m_msgInput = nullptr;  // NEW: text input for message
     QPushButton* m_sendBtn = nullptr; // NEW: send button
+    QPushButton* m_recordBtn = nullptr;
+    QPushButton* m_perfBtn = nullptr;  // Shows/hides the stats panel
+    QLabel* m_perfPanel = nullptr;     // Live throughput, drops and latency
+
+    // Recording
+    scpStreamRecorder* m_recorder = nullptr;
+    QTimer* m_recordTimer = nullptr;  // Refreshes recording stats in the status bar
 
     // Data sources
     scpAudioInputSource* m_audio = nullptr;
@@ -63,5 +82,9 @@ private:
     scpSimulatedAcquisitionSource* m_simAcq = nullptr;
     scpDataSource* m_current = nullptr;
 
+    // Statistics
+    scpThroughputMonitor* m_monitor = nullptr;
+    scpLatencyHistogram::Snapshot m_lastFrameTimes;  // Paint times at the previous panel update
+
     bool m_running = false;
 };
\ No newline at end of file
@@ -138,6 +138,7 @@ void scpMessageWaveSource::runLoop() {
                 ringHead_ = (ringHead_ + 1) % ringBuffer_.size();
             }
         }
+        if (!outChunk.empty()) stampSamples(scpMonotonicNs(), static_cast<int>(outChunk.size()));
 
         // Emit data to scope (emitData expects float* and count)
         if (!outChunk.empty()) {
@@ -0,0 +1,337 @@
+#include "scpMetricsExporter.h"
+#include "scpThroughputMonitor.h"
+#include "scpUsbReadController.h"
+#include "scpUsbWriteController.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <memory>
+
+// Requests larger than this are not scrapes; the connection is dropped
+static constexpr int kMaxRequestBytes = 8 * 1024;
+// Connections that send no complete request within this time are dropped
+static constexpr int kRequestTimeoutMs = 5000;
+// Histogram bucket edges: 2^3 - 1 us (7 us) .. 2^24 - 1 us (~16.8 s)
+static constexpr int kFirstEdgeBit = 3;
+static constexpr int kLastEdgeBit = 24;
+
+static QString escapeLabel(const QString& value) {
+    QString escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+
+static QString pipelineLabel(const QString& pipeline) {
+    return QString("pipeline=\"%1\"").arg(escapeLabel(pipeline));
+}
+
+static QString formatValue(double value) {
+    return QString::number(value, 'g', 12);
+}
+
+static double toSeconds(qint64 microseconds) {
+    return microseconds / 1e6;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+void scpMetricsExporter::Writer::family(const QString& name, const QString& help, const char* type) {
+    if (m_families.contains(name)) return;
+    QByteArray header;
+    header += "# HELP " + name.toUtf8() + ' ' + help.toUtf8() + '\n';
+    header += "# TYPE " + name.toUtf8() + ' ' + type + '\n';
+    m_families.insert(name, header);
+    m_order.append(name);
+}
+
+void scpMetricsExporter::Writer::sample(const QString& family, const QString& name,
+                                        const QString& labels, double value) {
+    QByteArray& lines = m_families[family];
+    lines += name.toUtf8();
+    if (!labels.isEmpty()) lines += '{' + labels.toUtf8() + '}';
+    lines += ' ' + formatValue(value).toUtf8() + '\n';
+}
+
+void scpMetricsExporter::Writer::counter(const QString& name, const QString& help,
+                                         double value, const QString& pipeline) {
+    family(name, help, "counter");
+    sample(name, name, pipelineLabel(pipeline), value);
+}
+
+void scpMetricsExporter::Writer::gauge(const QString& name, const QString& help,
+                                       double value, const QString& pipeline) {
+    family(name, help, "gauge");
+    sample(name, name, pipelineLabel(pipeline), value);
+}
+
+void scpMetricsExporter::Writer::histogram(const QString& name, const QString& help,
+                                           const scpLatencyHistogram::Snapshot& snapshot,
+                                           const QString& pipeline) {
+    family(name, help, "histogram");
+    const QString labels = pipelineLabel(pipeline);
+
+    // Samples are whole microseconds and each histogram bucket ends at 2^k - 1 us,
+    // so le="2^k - 1 us" counts exactly the values less than or equal to it
+    quint64 cumulative = 0;
+    size_t index = 0;
+    for (int bit = kFirstEdgeBit; bit <= kLastEdgeBit; ++bit) {
+        const qint64 edge = (qint64(1) << bit) - 1;
+        while (index < snapshot.counts.size() &&
+               scpLatencyHistogram::bucketUpperBound(static_cast<int>(index)) <= edge) {
+            cumulative += snapshot.counts[index++];
+        }
+        sample(name, name + "_bucket",
+               labels + QString(",le=\"%1\"").arg(formatValue(toSeconds(edge))),
+               static_cast<double>(cumulative));
+    }
+    sample(name, name + "_bucket", labels + ",le=\"+Inf\"", static_cast<double>(snapshot.count));
+    sample(name, name + "_sum", labels, toSeconds(snapshot.sum));
+    sample(name, name + "_count", labels, static_cast<double>(snapshot.count));
+}
+
+void scpMetricsExporter::Writer::quantiles(const QString& name, const QString& help,
+                                           const scpLatencyHistogram::Summary& summary,
+                                           const QString& window, const QString& pipeline) {
+    family(name, help, "gauge");
+    const QString labels = pipelineLabel(pipeline) + QString(",window=\"%1\"").arg(escapeLabel(window));
+    const struct { const char* quantile; qint64 value; } points[] = {
+        {"0.5", summary.p50}, {"0.9", summary.p90}, {"0.99", summary.p99},
+        {"0.999", summary.p999}, {"1", summary.max}
+    };
+    for (const auto& point : points) {
+        sample(name, name, labels + QString(",quantile=\"%1\"").arg(point.quantile),
+               toSeconds(point.value));
+    }
+}
+
+QByteArray scpMetricsExporter::Writer::text() const {
+    QByteArray out;
+    for (const QString& name : m_order) {
+        out += m_families.value(name);
+    }
+    return out;
+}
+
+// ============================================================================
+// Exporter
+// ============================================================================
+
+scpMetricsExporter::scpMetricsExporter(QObject* parent)
+    : QObject(parent)
+{
+}
+
+scpMetricsExporter::~scpMetricsExporter() {
+    close();
+}
+
+bool scpMetricsExporter::listenTcp(quint16 port, bool localhostOnly) {
+    if (!m_tcpServer) {
+        m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection, this, &scpMetricsExporter::onTcpConnection);
+    }
+    m_tcpServer->close();
+    const QHostAddress address = localhostOnly ? QHostAddress(QHostAddress::LocalHost)
+                                               : QHostAddress(QHostAddress::Any);
+    if (!m_tcpServer->listen(address, port)) {
+        handleError(QString("Cannot listen on %1:%2: %3")
+                    .arg(address.toString()).arg(port).arg(m_tcpServer->errorString()));
+        return false;
+    }
+    updateStatus(QString("Serving metrics on http://%1:%2/metrics")
+                 .arg(address.toString()).arg(m_tcpServer->serverPort()));
+    return true;
+}
+
+bool scpMetricsExporter::listenLocal(const QString& name) {
+    if (!m_localServer) {
+        m_localServer = new QLocalServer(this);
+        connect(m_localServer, &QLocalServer::newConnection, this, &scpMetricsExporter::onLocalConnection);
+    }
+    m_localServer->close();
+    // A socket file left behind by a crashed instance would block listen()
+    QLocalServer::removeServer(name);
+    m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_localServer->listen(name)) {
+        handleError(QString("Cannot listen on local socket %1: %2")
+                    .arg(name, m_localServer->errorString()));
+        return false;
+    }
+    updateStatus(QString("Serving metrics on local socket %1").arg(m_localServer->fullServerName()));
+    return true;
+}
+
+void scpMetricsExporter::close() {
+    if (m_tcpServer) m_tcpServer->close();
+    if (m_localServer) m_localServer->close();
+}
+
+bool scpMetricsExporter::isListening() const {
+    return (m_tcpServer && m_tcpServer->isListening()) ||
+           (m_localServer && m_localServer->isListening());
+}
+
+void scpMetricsExporter::addCollector(const QString& pipeline, Collector collector) {
+    m_entries.push_back({pipeline, std::move(collector)});
+}
+
+void scpMetricsExporter::addMonitor(const QString& pipeline, scpThroughputMonitor* monitor) {
+    QPointer<scpThroughputMonitor> guard(monitor);
+    addCollector(pipeline, [guard](Writer& out, const QString& p) {
+        if (!guard) return;
+        const scpThroughputMonitor* m = guard.data();
+        out.counter("scope_read_bytes_total", "Bytes read from the device", m->totalBytesRead(), p);
+        out.counter("scope_written_bytes_total", "Bytes written to the device", m->totalBytesWritten(), p);
+        out.counter("scope_samples_total", "Samples delivered", m->totalSamples(), p);
+        out.counter("scope_dropped_samples_total", "Samples dropped", m->totalDropped(), p);
+        out.counter("scope_lost_frames_total", "Sequence gaps reported by a framed reader", m->totalFramesLost(), p);
+        out.gauge("scope_read_bytes_per_second", "Read rate over the last update interval", m->bytesPerSecondRead(), p);
+        out.gauge("scope_written_bytes_per_second", "Write rate over the last update interval", m->bytesPerSecondWrite(), p);
+        out.gauge("scope_samples_per_second", "Sample rate over the last update interval", m->samplesPerSecond(), p);
+        out.gauge("scope_drop_ratio", "Fraction of samples dropped in the last update interval", m->dropRate(), p);
+        out.histogram("scope_latency_seconds", "Recorded latencies since start", m->latencySnapshot(), p);
+        out.quantiles("scope_latency_quantile_seconds", "Latency percentiles per window",
+                      m->intervalLatency(), "interval", p);
+        out.quantiles("scope_latency_quantile_seconds", "Latency percentiles per window",
+                      m->totalLatency(), "total", p);
+    });
+}
+
+void scpMetricsExporter::addReadController(const QString& pipeline, scpUsbReadController* controller) {
+    QPointer<scpUsbReadController> guard(controller);
+    addCollector(pipeline, [guard](Writer& out, const QString& p) {
+        if (!guard) return;
+        const scpUsbReadController* c = guard.data();
+        out.gauge("scope_usb_read_running", "1 while the reader is running", c->isRunning() ? 1 : 0, p);
+        out.counter("scope_usb_read_bytes_total", "Bytes delivered by the USB reader", c->totalBytesRead(), p);
+        out.counter("scope_usb_read_errors_total", "USB read errors", c->errorCount(), p);
+        out.counter("scope_usb_read_reconnects_total", "USB reader reconnects", c->reconnectCount(), p);
+        out.counter("scope_usb_read_lost_frames_total", "Sequence gaps seen by the USB reader", c->framesLost(), p);
+        out.counter("scope_usb_read_batches_total", "Batched blocks delivered", c->batchesDelivered(), p);
+        out.counter("scope_usb_read_batched_reads_total", "Reads merged into batches", c->readsBatched(), p);
+        out.counter("scope_usb_read_batch_overflow_bytes_total", "Bytes dropped by a full batch buffer",
+                    c->batchOverflowBytes(), p);
+    });
+}
+
+void scpMetricsExporter::addWriteController(const QString& pipeline, scpUsbWriteController* controller) {
+    QPointer<scpUsbWriteController> guard(controller);
+    addCollector(pipeline, [guard](Writer& out, const QString& p) {
+        if (!guard) return;
+        const scpUsbWriteController* c = guard.data();
+        out.gauge("scope_usb_write_running", "1 while the writer is running", c->isRunning() ? 1 : 0, p);
+        out.counter("scope_usb_write_bytes_total", "Bytes written by the USB writer", c->totalBytesWritten(), p);
+        out.counter("scope_usb_write_errors_total", "USB write errors", c->errorCount(), p);
+        out.counter("scope_usb_write_reconnects_total", "USB writer reconnects", c->reconnectCount(), p);
+        out.gauge("scope_usb_write_queue_bytes", "Bytes waiting in the write queue", c->queuedBytes(), p);
+        out.gauge("scope_usb_write_queue_packets", "Packets waiting in the write queue", c->queueSize(), p);
+        out.gauge("scope_usb_write_queue_budget_bytes", "Byte budget of the write queue", c->maxQueueBytes(), p);
+        out.counter("scope_usb_write_dropped_packets_total", "Packets dropped by the write queue", c->droppedPackets(), p);
+        out.counter("scope_usb_write_dropped_bytes_total", "Bytes dropped by the write queue", c->droppedBytes(), p);
+        out.counter("scope_usb_write_coalesced_packets_total", "Packets merged into larger writes",
+                    c->coalescedPackets(), p);
+        if (c->writeMode() == scpFTDIWriter::PacedMode) {
+            const scpFTDIWriter::PacingStats pacing = c->pacingStats();
+            out.gauge("scope_usb_write_target_bytes_per_second", "Paced write target rate",
+                      pacing.targetBytesPerSec, p);
+            out.gauge("scope_usb_write_achieved_bytes_per_second", "Paced write achieved rate",
+                      pacing.achievedBytesPerSec, p);
+            out.gauge("scope_usb_write_jitter_seconds", "Mean lateness of paced write ticks",
+                      pacing.meanJitterUs / 1e6, p);
+            out.counter("scope_usb_write_missed_ticks_total", "Paced write ticks skipped",
+                        pacing.missedTicks, p);
+        }
+    });
+}
+
+QByteArray scpMetricsExporter::render() const {
+    Writer out;
+    for (const Entry& entry : m_entries) {
+        entry.collect(out, entry.pipeline);
+    }
+    return out.text();
+}
+
+QByteArray scpMetricsExporter::handleRequest(const QByteArray& request) {
+    // Only the request line matters: "GET /metrics HTTP/1.1"
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    const QByteArray method = requestLine.value(0);
+    const QByteArray path = requestLine.value(1).split('?').value(0);
+
+    QByteArray status = "200 OK";
+    QByteArray contentType = "text/plain; version=0.0.4; charset=utf-8";
+    QByteArray body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain; charset=utf-8";
+        body = "Only GET is supported\n";
+    } else if (path != "/metrics" && path != "/") {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = "Metrics are served at /metrics\n";
+    } else {
+        ++m_scrapes;
+        body = render();
+    }
+
+    QByteArray response;
+    response += "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+static void finishConnection(QTcpSocket* socket) { socket->disconnectFromHost(); }
+static void finishConnection(QLocalSocket* socket) { socket->disconnectFromServer(); }
+
+// Reads one request, answers it and closes; the socket deletes itself afterwards
+template <typename Socket, typename DisconnectSignal>
+static void serveConnection(scpMetricsExporter* exporter, Socket* socket, DisconnectSignal disconnected) {
+    QObject::connect(socket, disconnected, socket, &QObject::deleteLater);
+    QTimer::singleShot(kRequestTimeoutMs, socket, [socket]() { socket->abort(); });
+
+    auto request = std::make_shared<QByteArray>();
+    QObject::connect(socket, &QIODevice::readyRead, socket, [exporter, socket, request]() {
+        *request += socket->readAll();
+        if (request->size() > kMaxRequestBytes) {
+            socket->abort();
+            return;
+        }
+        if (!request->contains("\r\n\r\n")) return;
+        // One request per connection; anything after it is ignored
+        QObject::disconnect(socket, &QIODevice::readyRead, socket, nullptr);
+        socket->write(exporter->handleRequest(*request));
+        finishConnection(socket);
+    });
+}
+
+void scpMetricsExporter::onTcpConnection() {
+    while (QTcpSocket* socket = m_tcpServer->nextPendingConnection()) {
+        serveConnection(this, socket, &QTcpSocket::disconnected);
+    }
+}
+
+void scpMetricsExporter::onLocalConnection() {
+    while (QLocalSocket* socket = m_localServer->nextPendingConnection()) {
+        serveConnection(this, socket, &QLocalSocket::disconnected);
+    }
+}
+
+void scpMetricsExporter::updateStatus(const QString& status) {
+    emit statusChanged(QString("[Metrics] %1").arg(status));
+}
+
+void scpMetricsExporter::handleError(const QString& error) {
+    QString fullError = QString("[Metrics Error] %1").arg(error);
+    qWarning() << fullError;
+    emit errorOccurred(fullError);
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+#include "scpLatencyHistogram.h"
+
+class QTcpServer;
+class QLocalServer;
+class scpThroughputMonitor;
+class scpUsbReadController;
+class scpUsbWriteController;
+
+/**
+ * @brief Serves pipeline statistics in the Prometheus text format
+ *
+ * Listens on a local TCP port and/or a local socket (a Unix domain socket,
+ * or a named pipe on Windows) and answers "GET /metrics" with a snapshot
+ * rendered on this object's thread, so scrapers never have to parse the
+ * statisticsUpdated() strings.
+ *
+ * What gets exported is registered up front: throughput monitors, USB
+ * controllers, or any collector function (views, sources). Every sample is
+ * labelled with the pipeline name it was registered under. Registered
+ * QObjects are tracked with QPointer and skipped once destroyed.
+ */
+class scpMetricsExporter : public QObject {
+    Q_OBJECT
+
+public:
+    // One exposition being built; samples of a metric family stay together
+    class Writer {
+    public:
+        void counter(const QString& name, const QString& help, double value, const QString& pipeline);
+        void gauge(const QString& name, const QString& help, double value, const QString& pipeline);
+        // Cumulative histogram in seconds, bucket edges at 2^k - 1 microseconds
+        void histogram(const QString& name, const QString& help,
+                       const scpLatencyHistogram::Snapshot& snapshot, const QString& pipeline);
+        // p50..p99.9 and max in seconds, as a gauge labelled by window and quantile
+        void quantiles(const QString& name, const QString& help,
+                       const scpLatencyHistogram::Summary& summary,
+                       const QString& window, const QString& pipeline);
+
+        QByteArray text() const;
+
+    private:
+        void family(const QString& name, const QString& help, const char* type);
+        void sample(const QString& family, const QString& name, const QString& labels, double value);
+
+        QHash<QString, QByteArray> m_families;
+        QStringList m_order;
+    };
+
+    using Collector = std::function<void(Writer& out, const QString& pipeline)>;
+
+    explicit scpMetricsExporter(QObject* parent = nullptr);
+    ~scpMetricsExporter() override;
+
+    // Listening; both may be active at once
+    bool listenTcp(quint16 port, bool localhostOnly = true);
+    bool listenLocal(const QString& name);
+    void close();
+    bool isListening() const;
+
+    // Metric sources
+    void addCollector(const QString& pipeline, Collector collector);
+    void addMonitor(const QString& pipeline, scpThroughputMonitor* monitor);
+    void addReadController(const QString& pipeline, scpUsbReadController* controller);
+    void addWriteController(const QString& pipeline, scpUsbWriteController* controller);
+
+    // Current exposition, and the full HTTP response to one request
+    QByteArray render() const;
+    QByteArray handleRequest(const QByteArray& request);
+
+    qint64 scrapeCount() const { return m_scrapes; }
+
+signals:
+    void errorOccurred(const QString& error);
+    void statusChanged(const QString& status);
+
+private slots:
+    void onTcpConnection();
+    void onLocalConnection();
+
+private:
+    struct Entry {
+        QString pipeline;
+        Collector collect;
+    };
+
+    void updateStatus(const QString& status);
+    void handleError(const QString& error);
+
+    QTcpServer* m_tcpServer = nullptr;
+    QLocalServer* m_localServer = nullptr;
+    std::vector<Entry> m_entries;
+    qint64 m_scrapes = 0;
+};
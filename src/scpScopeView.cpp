@@ -1,8 +1,11 @@
 #include "scpScopeView.h"
+#include "scpThroughputMonitor.h"
+#include "scpTrace.h"
 #include <QPainter>
 #include <QPaintEvent>
 #include <QFontMetrics>
 #include <QMutexLocker>
+#include <QElapsedTimer>
 #include <algorithm>
 #include <cmath>
 
@@ -45,6 +48,7 @@ void scpScopeView::onRefresh() {
 
 void scpScopeView::onSamplesReady(const float* data, int count) {
     if (!data || count <= 0) return;
+    SCP_TRACE_SCOPE("onSamplesReady");
     
     QMutexLocker lock(&m_bufferMutex);
     
@@ -62,7 +66,24 @@ void scpScopeView::onSamplesReady(const float* data, int count) {
 
 void scpScopeView::paintEvent(QPaintEvent* e) {
     Q_UNUSED(e);
-    QPainter p(this);
+    SCP_TRACE_SCOPE("paintEvent");
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    m_frameSampleNs = 0;
+    {
+        QPainter p(this);  // Ends (and flushes) before the frame is timed
+        drawFrame(p);
+    }
+    m_frameTimes.record(frameTimer.nsecsElapsed() / 1000);
+
+    // Sensor-to-pixel latency, once per block: the first frame that shows it
+    if (m_monitor && m_frameSampleNs > 0 && m_frameSampleNs != m_lastShownSampleNs) {
+        m_monitor->recordLatency(static_cast<int>((scpMonotonicNs() - m_frameSampleNs) / 1000));
+        m_lastShownSampleNs = m_frameSampleNs;
+    }
+}
+
+void scpScopeView::drawFrame(QPainter& p) {
     p.fillRect(rect(), palette().base());
     drawGrid(p);
 
@@ -84,6 +105,8 @@ void scpScopeView::paintEvent(QPaintEvent* e) {
         return;
     }
 
+    // Stamped before copying, so the samples drawn are at least this fresh
+    const qint64 sampleNs = m_source->newestSampleTimeNs();
     const int sr = m_source->sampleRate();
     const int needed = std::max(100, static_cast<int>(std::ceil(sr * m_timeWindowSec)));
     QVector<float> samples;
@@ -114,6 +137,7 @@ void scpScopeView::paintEvent(QPaintEvent* e) {
 
     if (got > 0) {
         drawWave(p, samples);
+        m_frameSampleNs = sampleNs;
     } else {
         p.setPen(Qt::DashLine);
         p.drawText(rect().adjusted(10,10,-10,-10), Qt::AlignLeft | Qt::AlignTop, 
@@ -154,6 +178,7 @@ void scpScopeView::drawGrid(QPainter& p) {
 }
 
 void scpScopeView::drawWave(QPainter& p, const QVector<float>& samples) {
+    SCP_TRACE_SCOPE("drawWave");
     const QRect r = rect().adjusted(8, 8, -8, -8);
     if (r.width() <= 1 || r.height() <= 1) return;
 
@@ -3,6 +3,7 @@
 #include <QTimer>
 #include <QPen>
 #include <QMutex>
+#include "scpLatencyHistogram.h"
 #include "scpView.h"
 #include "scpDataSource.h"
 
@@ -15,6 +16,11 @@ public:
     void setTotalTimeWindowSec(double sec10Div) override; // total time across the screen (10 divisions)
     void setVerticalScale(float unitsPerDiv) override;
 
+    // Time spent in each paintEvent() (us)
+    const scpLatencyHistogram& frameTimes() const { return m_frameTimes; }
+    // Receives the sensor-to-pixel latency of each block when it is first painted
+    void setThroughputMonitor(class scpThroughputMonitor* monitor) { m_monitor = monitor; }
+
 signals:
     void messageChangeRequested(const QString& newMessage);
 
@@ -26,6 +32,7 @@ private slots:
     void onSamplesReady(const float* data, int count);
 
 private:
+    void drawFrame(class QPainter& p);
     void drawGrid(class QPainter& p);
     void drawWave(class QPainter& p, const QVector<float>& samples);
 
@@ -38,4 +45,9 @@ private:
     QVector<float> m_signalBuffer;
     QMutex m_bufferMutex;
     bool m_useSignalBuffer = false;
+
+    scpLatencyHistogram m_frameTimes;
+    class scpThroughputMonitor* m_monitor = nullptr;
+    qint64 m_frameSampleNs = 0;      // Production time of the newest sample in this frame
+    qint64 m_lastShownSampleNs = 0;  // ... and of the last frame whose latency was recorded
 };
\ No newline at end of file
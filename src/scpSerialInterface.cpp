@@ -0,0 +1,284 @@
+#include "scpSerialInterface.h"
+#include <QDebug>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <termios.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+static constexpr int kDefaultReadBufferSize = 256 * 1024;
+
+static speed_t baudToSpeed(int baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 500000: return B500000;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+        case 4000000: return B4000000;
+        default: return 0;
+    }
+}
+
+static QString errnoString() {
+    return QString::fromLocal8Bit(strerror(errno));
+}
+
+// ============================================================================
+// SerialReadWorker - epoll loop
+// ============================================================================
+
+SerialReadWorker::SerialReadWorker(scpSerialReader* parent)
+    : m_parent(parent) {
+}
+
+void SerialReadWorker::run() {
+    scpSerialReader* reader = m_parent;
+    const quint64 run = reader->m_run;  // Set before this thread was started
+
+    // Stops the reader on its own thread, unless it has been restarted since
+    auto fail = [reader, run](const QString& err) {
+        QMetaObject::invokeMethod(reader, [reader, run, err]() {
+            emit reader->errorOccurred(err);
+            if (reader->m_run == run) reader->stop();
+        }, Qt::QueuedConnection);
+    };
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        fail(QString("epoll_create1 failed: %1").arg(errnoString()));
+        return;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = reader->m_fd;
+    int rc = epoll_ctl(epfd, EPOLL_CTL_ADD, reader->m_fd, &ev);
+    if (rc == 0) {
+        ev.events = EPOLLIN;
+        ev.data.fd = reader->m_wakeFd;
+        rc = epoll_ctl(epfd, EPOLL_CTL_ADD, reader->m_wakeFd, &ev);
+    }
+    if (rc != 0) {
+        fail(QString("epoll_ctl failed: %1").arg(errnoString()));
+        ::close(epfd);
+        return;
+    }
+
+    // One scratch buffer for the whole run; each block is emitted as a copy of its size
+    const int bufferSize = reader->m_readBufferSize;
+    QByteArray scratch(bufferSize, Qt::Uninitialized);
+    bool running = true;
+    while (running) {
+        struct epoll_event events[2];
+        int n = epoll_wait(epfd, events, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == reader->m_wakeFd) {
+                running = false;
+                continue;
+            }
+
+            // Drain everything the tty has buffered into one block
+            int filled = 0;
+            bool hangup = false;
+            while (filled < bufferSize) {
+                ssize_t got = ::read(reader->m_fd, scratch.data() + filled, bufferSize - filled);
+                if (got > 0) {
+                    filled += static_cast<int>(got);
+                } else if (got < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    // EAGAIN: drained. 0 or other errors: the other side went away
+                    hangup = (got == 0) || (errno != EAGAIN && errno != EWOULDBLOCK);
+                    break;
+                }
+            }
+
+            if (filled > 0) {
+                reader->m_totalBytesRead.fetch_add(filled, std::memory_order_relaxed);
+                emit reader->dataReceived(QByteArray(scratch.constData(), filled));
+                emit reader->readCompleted(filled);
+            }
+
+            if (hangup || ((events[i].events & (EPOLLHUP | EPOLLERR)) && filled == 0)) {
+                fail("Serial device disconnected");
+                running = false;
+            }
+        }
+    }
+
+    ::close(epfd);
+}
+
+// ============================================================================
+// scpSerialReader
+// ============================================================================
+
+scpSerialReader::scpSerialReader(QObject *parent)
+    : scpFTDIInterface(parent)
+    , m_fd(-1)
+    , m_wakeFd(-1)
+    , m_baudRate(115200)
+    , m_readBufferSize(kDefaultReadBufferSize)
+    , m_readWorker(nullptr)
+    , m_totalBytesRead(0)
+{
+}
+
+scpSerialReader::~scpSerialReader() {
+    stop();
+    close();
+}
+
+void scpSerialReader::setReadBufferSize(int bytes) {
+    if (bytes <= 0) {
+        emit errorOccurred("Read buffer size must be positive");
+        return;
+    }
+    m_readBufferSize = bytes;
+}
+
+bool scpSerialReader::open() {
+    if (m_isOpen) {
+        emit errorOccurred("Device already open");
+        return false;
+    }
+
+    if (m_devicePath.isEmpty()) {
+        emit errorOccurred("Device path not set");
+        return false;
+    }
+
+    m_fd = ::open(m_devicePath.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        emit errorOccurred(QString("Failed to open device: %1").arg(errnoString()));
+        return false;
+    }
+
+    if (!configureTty()) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        emit errorOccurred(QString("eventfd failed: %1").arg(errnoString()));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_isOpen = true;
+    m_totalBytesRead = 0;
+    emit statusChanged(QString("Serial reader opened: %1 @ %2 baud").arg(m_devicePath).arg(m_baudRate));
+    return true;
+}
+
+bool scpSerialReader::configureTty() {
+    struct termios tio;
+    if (tcgetattr(m_fd, &tio) != 0) {
+        emit errorOccurred(QString("Not a tty: %1").arg(errnoString()));
+        return false;
+    }
+
+    // Raw 8N1, no flow control, reads return whatever is available
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    const speed_t speed = baudToSpeed(m_baudRate);
+    if (speed == 0) {
+        emit errorOccurred(QString("Unsupported baud rate: %1").arg(m_baudRate));
+        return false;
+    }
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    if (tcsetattr(m_fd, TCSANOW, &tio) != 0) {
+        emit errorOccurred(QString("tcsetattr failed: %1").arg(errnoString()));
+        return false;
+    }
+    tcflush(m_fd, TCIFLUSH);
+
+    // Ask USB-serial drivers to push data up immediately instead of batching it;
+    // ptys and drivers without the ioctl simply ignore this
+    struct serial_struct serial;
+    if (ioctl(m_fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(m_fd, TIOCSSERIAL, &serial);
+    }
+    return true;
+}
+
+void scpSerialReader::close() {
+    stop();
+
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    if (m_wakeFd >= 0) {
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+
+    if (m_isOpen) {
+        m_isOpen = false;
+        emit statusChanged("Serial reader closed");
+    }
+}
+
+void scpSerialReader::start() {
+    if (!m_isOpen) {
+        emit errorOccurred("Cannot start: device not open");
+        return;
+    }
+
+    if (m_isRunning) {
+        return;
+    }
+
+    // Discard a stale wakeup left by a previous stop()
+    eventfd_t stale;
+    eventfd_read(m_wakeFd, &stale);
+
+    m_readWorker = new SerialReadWorker(this);
+    ++m_run;
+    m_isRunning = true;
+    m_readWorker->start(QThread::HighPriority);
+    emit statusChanged(QString("Serial reader started: %1 byte blocks").arg(m_readBufferSize));
+}
+
+void scpSerialReader::stop() {
+    if (!m_isRunning) {
+        return;
+    }
+
+    eventfd_write(m_wakeFd, 1);
+    if (m_readWorker) {
+        m_readWorker->wait();
+        delete m_readWorker;
+        m_readWorker = nullptr;
+    }
+    m_isRunning = false;
+    emit statusChanged(QString("Serial reader stopped. Total bytes read: %1").arg(totalBytesRead()));
+}
@@ -0,0 +1,76 @@
+#ifndef SCPSERIALINTERFACE_H
+#define SCPSERIALINTERFACE_H
+
+#include <QThread>
+#include <QByteArray>
+#include <atomic>
+#include "scpFTDIInterface.h"
+
+class SerialReadWorker;
+
+/**
+ * @brief Linux-native acquisition backend for USB-serial ttys
+ *
+ * Reads /dev/ttyUSB*, /dev/ttyACM* (or any tty, including the slave side
+ * of a pty pair) in raw termios mode. The descriptor is non-blocking and
+ * serviced by an epoll loop on a dedicated thread; every wakeup drains
+ * the kernel tty buffer into a reused scratch buffer and hands off a block
+ * of exactly the bytes read through dataReceived, so throughput no longer
+ * depends on a QTimer.
+ *
+ * Shares scpFTDIInterface's device path, state and error/status signals,
+ * and emits the same dataReceived/readCompleted pair as scpFTDIReader.
+ */
+class scpSerialReader : public scpFTDIInterface {
+    Q_OBJECT
+
+public:
+    explicit scpSerialReader(QObject *parent = nullptr);
+    ~scpSerialReader() override;
+
+    // Configuration (applied on open())
+    void setBaudRate(int baud) { m_baudRate = baud; }
+    int baudRate() const { return m_baudRate; }
+    // Largest block handed off per wakeup
+    void setReadBufferSize(int bytes);
+    int readBufferSize() const { return m_readBufferSize; }
+
+    // Operations
+    bool open() override;
+    void close() override;
+    void start();
+    void stop();
+
+    qint64 totalBytesRead() const { return m_totalBytesRead.load(std::memory_order_relaxed); }
+
+signals:
+    void dataReceived(const QByteArray& data);
+    void readCompleted(int bytesRead);
+
+private:
+    friend class SerialReadWorker;
+    bool configureTty();
+
+    int m_fd;
+    int m_wakeFd;        // eventfd used to interrupt epoll_wait on stop()
+    int m_baudRate;
+    int m_readBufferSize;
+    SerialReadWorker* m_readWorker;
+    quint64 m_run = 0;   // Counts starts, so calls queued by a finished run are ignored
+    std::atomic<qint64> m_totalBytesRead;
+};
+
+// Worker thread running the epoll loop for scpSerialReader
+class SerialReadWorker : public QThread {
+    Q_OBJECT
+public:
+    explicit SerialReadWorker(scpSerialReader* parent);
+
+protected:
+    void run() override;
+
+private:
+    scpSerialReader* m_parent;
+};
+
+#endif // SCPSERIALINTERFACE_H
@@ -64,4 +64,5 @@ void scpSignalGeneratorSource::onTick() {
         m_buffer[m_bufferWritePos] = static_cast<float>(s);
         m_bufferWritePos = (m_bufferWritePos + 1) % m_bufferSize;
     }
+    stampSamples(scpMonotonicNs(), frames);
 }
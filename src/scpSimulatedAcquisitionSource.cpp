@@ -1,4 +1,5 @@
 #include "scpSimulatedAcquisitionSource.h"
+#include "scpTrace.h"
 #include <QDebug>
 #include <algorithm>
 #include <cmath>
@@ -17,6 +18,7 @@ void SimulatedAcquisitionWorker::stop() {
 }
 
 void SimulatedAcquisitionWorker::run() {
+    SCP_TRACE_THREAD_NAME("sim acquisition");
     const int sampleRate = m_parent->m_sampleRate;
     const double samplePeriod = 1.0 / sampleRate;
     const int chunkSize = sampleRate / 100;  // Generate ~10ms chunks at a time
@@ -37,22 +39,25 @@ void SimulatedAcquisitionWorker::run() {
         }
 
         // Generate chunk
-        for (int i = 0; i < chunkSize; ++i) {
-            float sample = 0.0f;
-
-            if (waveformType == scpSimulatedAcquisitionSource::NoisySine) {
-                // Generate sine wave with noise
-                float sineValue = std::sin(2.0 * M_PI * phase);
-                float noise = m_noiseDist(m_rng) * noiseLevel;
-                sample = sineValue + noise;
-                phase += frequency * samplePeriod;
-                if (phase >= 1.0) phase -= 1.0;
-            } else {  // Random
-                // Generate random analog-like data
-                sample = m_randomDist(m_rng);
+        {
+            SCP_TRACE_SCOPE("generate");
+            for (int i = 0; i < chunkSize; ++i) {
+                float sample = 0.0f;
+
+                if (waveformType == scpSimulatedAcquisitionSource::NoisySine) {
+                    // Generate sine wave with noise
+                    float sineValue = std::sin(2.0 * M_PI * phase);
+                    float noise = m_noiseDist(m_rng) * noiseLevel;
+                    sample = sineValue + noise;
+                    phase += frequency * samplePeriod;
+                    if (phase >= 1.0) phase -= 1.0;
+                } else {  // Random
+                    // Generate random analog-like data
+                    sample = m_randomDist(m_rng);
+                }
+
+                chunk[i] = sample;
             }
-
-            chunk[i] = sample;
         }
 
         // Send samples to parent
@@ -196,12 +201,15 @@ float scpSimulatedAcquisitionSource::noiseLevel() const {
 
 void scpSimulatedAcquisitionSource::receiveSamples(const float* data, int count) {
     if (!data || count <= 0) return;
+    SCP_TRACE_SCOPE("receiveSamples");
+    const qint64 producedNs = scpMonotonicNs();  // The worker calls this right after generating
 
     QMutexLocker lock(&m_bufferMutex);
     for (int i = 0; i < count; ++i) {
         m_buffer[m_bufferWritePos] = data[i];
         m_bufferWritePos = (m_bufferWritePos + 1) % m_bufferSize;
     }
+    stampSamples(producedNs, count);
 
     // Emit signal for real-time updates
     emit samplesReady(data, count);
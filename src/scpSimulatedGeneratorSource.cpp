@@ -1,4 +1,5 @@
 #include "scpSimulatedGeneratorSource.h"
+#include "scpTrace.h"
 #include <QDebug>
 #include <algorithm>
 #include <cmath>
@@ -14,6 +15,7 @@ void SimulatedGeneratorWorker::stop() {
 }
 
 void SimulatedGeneratorWorker::run() {
+    SCP_TRACE_THREAD_NAME("sim generator");
     const int sampleRate = m_parent->m_sampleRate;
     const double samplePeriod = 1.0 / sampleRate;
     const int chunkSize = sampleRate / 100;  // Generate ~10ms chunks at a time
@@ -36,35 +38,38 @@ void SimulatedGeneratorWorker::run() {
         }
 
         // Generate chunk
-        for (int i = 0; i < chunkSize; ++i) {
-            float sample = 0.0f;
-
-            switch (waveformType) {
-                case scpSimulatedGeneratorSource::Sine: {
-                    sample = std::sin(2.0 * M_PI * phase);
-                    break;
-                }
-                case scpSimulatedGeneratorSource::Square: {
-                    sample = (phase < 0.5) ? 1.0f : -1.0f;
-                    break;
-                }
-                case scpSimulatedGeneratorSource::Triangle: {
-                    if (phase < 0.5) {
-                        sample = 4.0f * phase - 1.0f;  // -1 to +1 over first half
-                    } else {
-                        sample = 3.0f - 4.0f * phase;  // +1 to -1 over second half
+        {
+            SCP_TRACE_SCOPE("generate");
+            for (int i = 0; i < chunkSize; ++i) {
+                float sample = 0.0f;
+
+                switch (waveformType) {
+                    case scpSimulatedGeneratorSource::Sine: {
+                        sample = std::sin(2.0 * M_PI * phase);
+                        break;
+                    }
+                    case scpSimulatedGeneratorSource::Square: {
+                        sample = (phase < 0.5) ? 1.0f : -1.0f;
+                        break;
+                    }
+                    case scpSimulatedGeneratorSource::Triangle: {
+                        if (phase < 0.5) {
+                            sample = 4.0f * phase - 1.0f;  // -1 to +1 over first half
+                        } else {
+                            sample = 3.0f - 4.0f * phase;  // +1 to -1 over second half
+                        }
+                        break;
                     }
-                    break;
                 }
-            }
 
-            // Apply amplitude and offset
-            sample = sample * amplitude + offset;
-            chunk[i] = sample;
+                // Apply amplitude and offset
+                sample = sample * amplitude + offset;
+                chunk[i] = sample;
 
-            // Update phase
-            phase += frequency * samplePeriod;
-            if (phase >= 1.0) phase -= 1.0;
+                // Update phase
+                phase += frequency * samplePeriod;
+                if (phase >= 1.0) phase -= 1.0;
+            }
         }
 
         // Send samples to parent
@@ -218,12 +223,15 @@ float scpSimulatedGeneratorSource::offset() const {
 
 void scpSimulatedGeneratorSource::receiveSamples(const float* data, int count) {
     if (!data || count <= 0) return;
+    SCP_TRACE_SCOPE("receiveSamples");
+    const qint64 producedNs = scpMonotonicNs();  // The worker calls this right after generating
 
     QMutexLocker lock(&m_bufferMutex);
     for (int i = 0; i < count; ++i) {
         m_buffer[m_bufferWritePos] = data[i];
         m_bufferWritePos = (m_bufferWritePos + 1) % m_bufferSize;
     }
+    stampSamples(producedNs, count);
 
     // Emit signal for real-time updates
     emit samplesReady(data, count);
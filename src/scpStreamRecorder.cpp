@@ -0,0 +1,348 @@
+#include "scpStreamRecorder.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+// O_DIRECT requires buffer address, length and file offset to be block aligned
+static constexpr int kAlignment = 4096;
+static constexpr int kDefaultBlockSize = 1024 * 1024;
+static constexpr int kDefaultBufferCount = 2;
+// Give a source this long to emit samplesReady before falling back to polling
+static constexpr int kPollGraceMs = 100;
+static constexpr int kPollIntervalMs = 20;
+
+static int alignUp(qint64 bytes) {
+    return static_cast<int>((bytes + kAlignment - 1) / kAlignment * kAlignment);
+}
+
+// ============================================================================
+// StreamRecorderWriter
+// ============================================================================
+
+StreamRecorderWriter::StreamRecorderWriter(scpStreamRecorder* recorder)
+    : m_recorder(recorder) {
+}
+
+void StreamRecorderWriter::run() {
+    scpStreamRecorder* rec = m_recorder;
+    QElapsedTimer timer;
+
+    for (;;) {
+        int block = -1;
+        int bytes = 0;
+        {
+            QMutexLocker lock(&rec->m_mutex);
+            while (rec->m_fullBlocks.empty() && !rec->m_stopping) {
+                rec->m_blockReady.wait(&rec->m_mutex);
+            }
+            if (rec->m_fullBlocks.empty()) return;  // Stopping and drained
+            block = rec->m_fullBlocks.front().first;
+            bytes = rec->m_fullBlocks.front().second;
+            rec->m_fullBlocks.pop_front();
+        }
+
+        timer.start();
+        const bool ok = rec->writeBlock(rec->m_blocks[block], bytes);
+        const double ms = timer.nsecsElapsed() / 1e6;
+
+        QMutexLocker lock(&rec->m_mutex);
+        rec->m_freeBlocks.append(block);
+        if (!ok) {
+            // Keep draining so the producer is never starved of blocks; the data is lost
+            rec->m_stats.droppedSamples += bytes / static_cast<int>(sizeof(float));
+            const QString err = QString("Recording write failed: %1").arg(rec->m_writeError);
+            QMetaObject::invokeMethod(rec, [rec, err]() { emit rec->errorOccurred(err); },
+                                      Qt::QueuedConnection);
+            continue;
+        }
+        rec->m_stats.bytesWritten += bytes;
+        rec->m_stats.samplesWritten += bytes / static_cast<int>(sizeof(float));
+        rec->m_stats.blocksWritten++;
+        rec->m_stats.lastWriteMs = ms;
+        rec->m_stats.maxWriteMs = std::max(rec->m_stats.maxWriteMs, ms);
+        rec->m_totalWriteMs += ms;
+        rec->m_stats.avgWriteMs = rec->m_totalWriteMs / rec->m_stats.blocksWritten;
+    }
+}
+
+// ============================================================================
+// scpStreamRecorder
+// ============================================================================
+
+scpStreamRecorder::scpStreamRecorder(QObject* parent)
+    : QObject(parent)
+    , m_blockSize(kDefaultBlockSize)
+    , m_bufferCount(kDefaultBufferCount)
+    , m_wantDirectIO(true)
+{
+    m_pollTimer.setInterval(kPollIntervalMs);
+    connect(&m_pollTimer, &QTimer::timeout, this, &scpStreamRecorder::pollSource);
+}
+
+scpStreamRecorder::~scpStreamRecorder() {
+    stop();
+}
+
+void scpStreamRecorder::setBlockSize(int bytes) {
+    if (bytes <= 0) {
+        emit errorOccurred("Block size must be positive");
+        return;
+    }
+    // Whole pages, and a whole number of samples
+    m_blockSize = alignUp(bytes);
+}
+
+void scpStreamRecorder::setBufferCount(int count) {
+    m_bufferCount = std::max(2, count);
+}
+
+scpStreamRecorder::Stats scpStreamRecorder::stats() const {
+    QMutexLocker lock(&m_mutex);
+    return m_stats;
+}
+
+bool scpStreamRecorder::start(scpDataSource* source, const QString& path) {
+    if (m_recording) {
+        emit errorOccurred("Already recording");
+        return false;
+    }
+    if (!source || path.isEmpty()) {
+        emit errorOccurred("Recording needs a source and a file path");
+        return false;
+    }
+
+    m_path = path;
+    if (!openOutput()) {
+        return false;
+    }
+
+    m_blocks.clear();
+    m_freeBlocks.clear();
+    for (int i = 0; i < m_bufferCount; ++i) {
+        char* block = static_cast<char*>(qMallocAligned(static_cast<size_t>(m_blockSize), kAlignment));
+        if (!block) {
+            releaseBlocks();
+            closeOutput();
+            emit errorOccurred("Out of memory for recording buffers");
+            return false;
+        }
+        m_blocks.append(block);
+        m_freeBlocks.append(i);
+    }
+    m_fillBlock = m_freeBlocks.takeLast();
+    m_fillBytes = 0;
+    m_fullBlocks.clear();
+    m_stopping = false;
+    m_stats = Stats();
+    m_stats.directIO = m_directIO;
+    m_totalWriteMs = 0.0;
+
+    m_writer = new StreamRecorderWriter(this);
+    m_writer->start();
+
+    // The pointer in samplesReady is only valid during the emit, so copy in place
+    m_source = source;
+    m_sawSignal = false;
+    m_polledSamples = 0;
+    m_samplesConnection = connect(m_source, &scpDataSource::samplesReady, this,
+                                  [this](const float* data, int count) { onSamples(data, count); },
+                                  Qt::DirectConnection);
+    m_pollClock.start();
+    m_pollTimer.start();
+
+    m_recording = true;
+    emit recordingStarted(m_path);
+    return true;
+}
+
+void scpStreamRecorder::stop() {
+    if (!m_recording) return;
+
+    m_pollTimer.stop();
+    disconnect(m_samplesConnection);
+
+    {
+        QMutexLocker lock(&m_mutex);
+        // Flush the partially filled block, then let the writer drain and exit
+        if (m_fillBlock >= 0 && m_fillBytes > 0) {
+            m_fullBlocks.emplace_back(m_fillBlock, m_fillBytes);
+            m_fillBlock = -1;
+        }
+        m_stopping = true;
+        m_blockReady.wakeAll();
+    }
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+
+    closeOutput();
+    releaseBlocks();
+
+    m_recording = false;
+    m_source = nullptr;
+    const qint64 samples = stats().samplesWritten;
+    emit recordingStopped(m_path, samples);
+}
+
+void scpStreamRecorder::onSamples(const float* data, int count) {
+    m_sawSignal.store(true, std::memory_order_relaxed);
+    appendSamples(data, count);
+}
+
+void scpStreamRecorder::appendSamples(const float* data, int count) {
+    if (!data || count <= 0) return;
+
+    QMutexLocker lock(&m_mutex);
+    if (m_stopping) return;
+
+    const char* bytes = reinterpret_cast<const char*>(data);
+    qint64 remaining = static_cast<qint64>(count) * sizeof(float);
+    while (remaining > 0) {
+        if (m_fillBlock < 0) {
+            if (m_freeBlocks.isEmpty()) {
+                // Writer is behind and every block is in use: drop rather than grow
+                m_stats.droppedSamples += remaining / static_cast<qint64>(sizeof(float));
+                return;
+            }
+            m_fillBlock = m_freeBlocks.takeLast();
+            m_fillBytes = 0;
+        }
+
+        const int n = static_cast<int>(std::min<qint64>(remaining, m_blockSize - m_fillBytes));
+        memcpy(m_blocks[m_fillBlock] + m_fillBytes, bytes, static_cast<size_t>(n));
+        m_fillBytes += n;
+        bytes += n;
+        remaining -= n;
+
+        if (m_fillBytes == m_blockSize) {
+            m_fullBlocks.emplace_back(m_fillBlock, m_fillBytes);
+            m_fillBlock = -1;
+            m_blockReady.wakeOne();
+        }
+    }
+}
+
+void scpStreamRecorder::pollSource() {
+    if (m_sawSignal.load(std::memory_order_relaxed)) {
+        // The source streams samplesReady; the direct connection has it covered
+        m_pollTimer.stop();
+        return;
+    }
+    if (!m_source || !m_source->isActive() || m_pollClock.elapsed() < kPollGraceMs) {
+        return;
+    }
+
+    // Pull whatever the source produced since the last poll, judged by its rate
+    const int rate = std::max(1, m_source->sampleRate());
+    const qint64 due = m_pollClock.nsecsElapsed() * rate / 1000000000LL;
+    const int wanted = static_cast<int>(std::min<qint64>(due - m_polledSamples, rate));
+    if (wanted <= 0) return;
+
+    const int got = m_source->copyRecentSamples(wanted, m_pollScratch);
+    appendSamples(m_pollScratch.constData(), got);
+    m_polledSamples = due;
+}
+
+bool scpStreamRecorder::openOutput() {
+    m_fileOffset = 0;
+#ifdef Q_OS_LINUX
+    const QByteArray path = m_path.toLocal8Bit();
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    m_directIO = false;
+    m_fd = -1;
+    if (m_wantDirectIO) {
+        m_fd = ::open(path.constData(), flags | O_DIRECT, 0644);
+        m_directIO = m_fd >= 0;
+    }
+    if (m_fd < 0) {
+        // tmpfs and some network filesystems refuse O_DIRECT
+        m_fd = ::open(path.constData(), flags, 0644);
+    }
+    if (m_fd < 0) {
+        emit errorOccurred(QString("Failed to open recording file: %1").arg(strerror(errno)));
+        return false;
+    }
+    return true;
+#else
+    m_directIO = false;
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        emit errorOccurred(QString("Failed to open recording file: %1").arg(m_file.errorString()));
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool scpStreamRecorder::writeBlock(const char* data, qint64 bytes) {
+#ifdef Q_OS_LINUX
+    // O_DIRECT writes whole pages; the padding is cut off again in closeOutput()
+    const qint64 toWrite = m_directIO ? alignUp(bytes) : bytes;
+    if (toWrite > bytes) {
+        memset(const_cast<char*>(data) + bytes, 0, static_cast<size_t>(toWrite - bytes));
+    }
+    // Written at the end of the last whole block, so the next block overwrites
+    // whatever a failed one left behind
+    qint64 done = 0;
+    while (done < toWrite) {
+        const ssize_t n = ::pwrite(m_fd, data + done, static_cast<size_t>(toWrite - done),
+                                   m_fileOffset + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            m_writeError = QString::fromLocal8Bit(strerror(errno));
+            return false;
+        }
+        // O_DIRECT can only carry on from a page boundary: rewrite the torn page
+        const qint64 next = m_directIO ? (done + n) / kAlignment * kAlignment : done + n;
+        if (next == done) {
+            m_writeError = QString("Short write at offset %1").arg(m_fileOffset + done);
+            return false;
+        }
+        done = next;
+    }
+    m_fileOffset += bytes;
+    return true;
+#else
+    if (!m_file.seek(m_fileOffset) || m_file.write(data, bytes) != bytes) {
+        m_writeError = m_file.errorString();
+        return false;
+    }
+    m_fileOffset += bytes;
+    return true;
+#endif
+}
+
+void scpStreamRecorder::closeOutput() {
+#ifdef Q_OS_LINUX
+    if (m_fd < 0) return;
+    // Drop the O_DIRECT padding of the final block and any partial write after it
+    if (::ftruncate(m_fd, m_fileOffset) != 0) {
+        qWarning() << "scpStreamRecorder: failed to trim recording:" << strerror(errno);
+    }
+    ::close(m_fd);
+    m_fd = -1;
+#else
+    if (!m_file.isOpen()) return;
+    if (!m_file.resize(m_fileOffset)) {
+        qWarning() << "scpStreamRecorder: failed to trim recording:" << m_file.errorString();
+    }
+    m_file.close();
+#endif
+}
+
+void scpStreamRecorder::releaseBlocks() {
+    // A late samplesReady already in flight sees m_stopping and leaves the blocks alone
+    QMutexLocker lock(&m_mutex);
+    for (char* block : m_blocks) qFreeAligned(block);
+    m_blocks.clear();
+    m_freeBlocks.clear();
+    m_fullBlocks.clear();
+    m_fillBlock = -1;
+    m_fillBytes = 0;
+}
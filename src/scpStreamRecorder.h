@@ -0,0 +1,137 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include "scpDataSource.h"
+
+class StreamRecorderWriter;
+
+/**
+ * @brief Streams every sample of a data source to disk
+ *
+ * Samples arrive through samplesReady (direct connection, on whatever
+ * thread the source emits from) and are copied into one of a fixed set of
+ * page-aligned blocks. Full blocks are written by a dedicated thread while
+ * the next one fills, so memory is bounded by bufferCount x blockSize:
+ * when the disk falls behind and no block is free, samples are dropped and
+ * counted rather than queued without limit.
+ *
+ * On Linux the file is opened with O_DIRECT where the filesystem allows
+ * it; elsewhere, or if it is refused, plain unbuffered writes are used.
+ *
+ * Sources that never emit samplesReady are polled via copyRecentSamples()
+ * from elapsed time and sampleRate(), which is close but not sample exact.
+ *
+ * Output is raw native-endian float32, one value per sample.
+ */
+class scpStreamRecorder : public QObject {
+    Q_OBJECT
+
+public:
+    struct Stats {
+        qint64 samplesWritten = 0;
+        qint64 bytesWritten = 0;
+        qint64 droppedSamples = 0;
+        qint64 blocksWritten = 0;
+        double lastWriteMs = 0.0;
+        double avgWriteMs = 0.0;
+        double maxWriteMs = 0.0;
+        bool directIO = false;
+    };
+
+    explicit scpStreamRecorder(QObject* parent = nullptr);
+    ~scpStreamRecorder() override;
+
+    // Configuration (takes effect on next start())
+    void setBlockSize(int bytes);
+    int blockSize() const { return m_blockSize; }
+    void setBufferCount(int count);
+    int bufferCount() const { return m_bufferCount; }
+    void setDirectIO(bool enable) { m_wantDirectIO = enable; }
+    bool directIO() const { return m_wantDirectIO; }
+
+    // Operations
+    bool start(scpDataSource* source, const QString& path);
+    void stop();
+
+    bool isRecording() const { return m_recording; }
+    QString path() const { return m_path; }
+    scpDataSource* source() const { return m_source; }
+    Stats stats() const;
+
+signals:
+    void recordingStarted(const QString& path);
+    void recordingStopped(const QString& path, qint64 samplesWritten);
+    void errorOccurred(const QString& error);
+
+private slots:
+    void pollSource();
+
+private:
+    friend class StreamRecorderWriter;
+
+    void onSamples(const float* data, int count);
+    void appendSamples(const float* data, int count);
+    bool openOutput();
+    bool writeBlock(const char* data, qint64 bytes);
+    void closeOutput();
+    void releaseBlocks();
+
+    // Configuration
+    int m_blockSize;
+    int m_bufferCount;
+    bool m_wantDirectIO;
+
+    scpDataSource* m_source = nullptr;
+    QMetaObject::Connection m_samplesConnection;
+    QString m_path;
+    bool m_recording = false;
+
+    // Output
+    int m_fd = -1;              // Linux descriptor (possibly O_DIRECT)
+    QFile m_file;               // Other platforms
+    bool m_directIO = false;
+    qint64 m_fileOffset = 0;    // End of the last block written in full (writer thread)
+    QString m_writeError;
+
+    // Blocks: one being filled, full ones queued to the writer, the rest free
+    mutable QMutex m_mutex;
+    QWaitCondition m_blockReady;
+    QVector<char*> m_blocks;
+    QVector<int> m_freeBlocks;
+    std::deque<std::pair<int, int>> m_fullBlocks;  // (block, bytes used)
+    int m_fillBlock = -1;
+    int m_fillBytes = 0;
+    bool m_stopping = false;
+    StreamRecorderWriter* m_writer = nullptr;
+    Stats m_stats;
+    double m_totalWriteMs = 0.0;
+
+    // Polling fallback for sources without samplesReady
+    QTimer m_pollTimer;
+    QElapsedTimer m_pollClock;
+    std::atomic<bool> m_sawSignal{false};
+    qint64 m_polledSamples = 0;
+    QVector<float> m_pollScratch;
+};
+
+// Thread that writes full blocks for scpStreamRecorder
+class StreamRecorderWriter : public QThread {
+    Q_OBJECT
+public:
+    explicit StreamRecorderWriter(scpStreamRecorder* recorder);
+
+protected:
+    void run() override;
+
+private:
+    scpStreamRecorder* m_recorder;
+};
@@ -3,6 +3,9 @@
 #include "scpSignalGeneratorSource.h"
 #include "scpSimulatedGeneratorSource.h"
 #include "scpSimulatedAcquisitionSource.h"
+#include "scpStreamRecorder.h"
+#include "scpThroughputMonitor.h"
+#include "scpTrace.h"
 #include <QTextStream>
 #include <QCoreApplication>
 #include <QDebug>
@@ -12,6 +15,11 @@ scpTerminalController::scpTerminalController(QObject* parent)
     m_sampleForTimer = new QTimer(this);
     m_sampleForTimer->setSingleShot(true);
     connect(m_sampleForTimer, &QTimer::timeout, this, &scpTerminalController::onSampleForTimeout);
+
+    m_recorder = new scpStreamRecorder(this);
+    connect(m_recorder, &scpStreamRecorder::errorOccurred, this, [this](const QString& error) {
+        writeResponse(QString("[Error] %1").arg(error));
+    });
 }
 
 scpTerminalController::~scpTerminalController() {
@@ -53,6 +61,13 @@ bool scpTerminalController::processCommand(const QString& line) {
     const QString cmd = processedLine.section(' ', 0, 0);
     const QString arg = processedLine.section(' ', 1);
 
+    // File paths must keep their case
+    QString rawLine = line.trimmed();
+    if (rawLine.startsWith("scope ", Qt::CaseInsensitive)) {
+        rawLine = rawLine.mid(6);
+    }
+    const QString rawArg = rawLine.section(' ', 1);
+
     if (cmd == "quit" || cmd == "exit") {
         emit quitRequested();
         return true;
@@ -80,8 +95,14 @@ bool scpTerminalController::processCommand(const QString& line) {
         return handleWaveform(arg);
     } else if (cmd == "noiselevel") {
         return handleNoiseLevel(arg);
+    } else if (cmd == "record") {
+        return handleRecord(rawArg);
+    } else if (cmd == "trace") {
+        return handleTrace(rawArg);
     } else if (cmd == "status") {
         return handleStatus(arg);
+    } else if (cmd == "perf") {
+        return handlePerf(arg);
     } else if (cmd == "help" || cmd == "?") {
         return handleHelp(arg);
     } else if (cmd.isEmpty()) {
@@ -364,9 +385,52 @@ bool scpTerminalController::handleNoiseLevel(const QString& arg) {
     }
 }
 
+bool scpTerminalController::handleRecord(const QString& arg) {
+    const QString what = arg.trimmed();
+
+    if (what.isEmpty()) {
+        if (!m_recorder->isRecording()) {
+            writeResponse("Not recording. Use: record <file> | record stop");
+            return true;
+        }
+        const scpStreamRecorder::Stats st = m_recorder->stats();
+        writeResponse(QString("Recording to %1: %2 samples, %3 dropped, write avg %4 ms / max %5 ms%6")
+                     .arg(m_recorder->path()).arg(st.samplesWritten).arg(st.droppedSamples)
+                     .arg(st.avgWriteMs, 0, 'f', 2).arg(st.maxWriteMs, 0, 'f', 2)
+                     .arg(st.directIO ? " (O_DIRECT)" : ""));
+        return true;
+    }
+
+    if (what.compare("stop", Qt::CaseInsensitive) == 0) {
+        if (!m_recorder->isRecording()) {
+            writeResponse("Not recording.");
+            return false;
+        }
+        const QString path = m_recorder->path();
+        m_recorder->stop();
+        const scpStreamRecorder::Stats st = m_recorder->stats();
+        writeResponse(QString("✓ Recording stopped: %1 samples written to %2 (%3 dropped)")
+                     .arg(st.samplesWritten).arg(path).arg(st.droppedSamples));
+        return true;
+    }
+
+    // In combined mode record the acquisition channel
+    scpDataSource* target = m_combinedMode ? m_acquisitionSource : m_source;
+    if (!target) {
+        writeResponse("✗ No source configured.");
+        return false;
+    }
+    if (!m_recorder->start(target, what)) {
+        return false;
+    }
+    writeResponse(QString("✓ Recording %1 at %2 Hz to %3 (raw float32)")
+                 .arg(target->metaObject()->className()).arg(target->sampleRate()).arg(what));
+    return true;
+}
+
 bool scpTerminalController::handleStatus(const QString& arg) {
-    Q_UNUSED(arg);
-    
+    const bool withPerf = arg.split(' ', Qt::SkipEmptyParts).contains("--perf");
+
     *m_out << Qt::endl << "--- Current Scope Status ---" << Qt::endl;
     
     if (m_combinedMode) {
@@ -432,8 +496,61 @@ bool scpTerminalController::handleStatus(const QString& arg) {
         return false;
     }
 
+    if (m_recorder->isRecording()) {
+        const scpStreamRecorder::Stats st = m_recorder->stats();
+        *m_out << "  Recording: " << m_recorder->path() << " (" << st.samplesWritten
+               << " samples, " << st.droppedSamples << " dropped)" << Qt::endl;
+    }
+
     *m_out << "----------------------------" << Qt::endl;
     m_out->flush();
+    return withPerf ? handlePerf(QString()) : true;
+}
+
+bool scpTerminalController::handlePerf(const QString& arg) {
+    if (!m_monitor) {
+        writeResponse("✗ No throughput monitor configured.");
+        return false;
+    }
+    if (arg.trimmed() == "reset") {
+        m_monitor->reset();
+        writeResponse("Throughput statistics reset.");
+        return true;
+    }
+    if (!arg.trimmed().isEmpty()) {
+        writeResponse("Use: perf | perf reset");
+        return false;
+    }
+
+    // Rates are those of the monitor's last update interval, totals are live
+    *m_out << Qt::endl << m_monitor->getStatisticsString();
+    *m_out << QString("(updated every %1 ms)").arg(m_monitor->updateInterval()) << Qt::endl;
+    m_out->flush();
+    return true;
+}
+
+bool scpTerminalController::handleTrace(const QString& arg) {
+    const QString what = arg.trimmed();
+    if (!scpTracer::compiledIn()) {
+        writeResponse("✗ Tracing is not compiled in (configure with -DSCP_WITH_TRACING=ON).");
+        return false;
+    }
+    if (what.isEmpty()) {
+        writeResponse("Use: trace <file> | trace clear");
+        return true;
+    }
+    if (what.compare("clear", Qt::CaseInsensitive) == 0) {
+        scpTracer::clear();
+        writeResponse("Trace events cleared.");
+        return true;
+    }
+
+    QString error;
+    if (!scpTracer::writeChromeTrace(what, &error)) {
+        writeResponse(QString("✗ %1").arg(error));
+        return false;
+    }
+    writeResponse(QString("✓ Trace written to %1 (open in chrome://tracing or ui.perfetto.dev)").arg(what));
     return true;
 }
 
@@ -462,8 +579,20 @@ bool scpTerminalController::handleHelp(const QString& arg) {
     *m_out << "Acquisition Commands (for acquisition sources):" << Qt::endl;
     *m_out << "  noiseLevel <0.0-1.0>         Set noise level (e.g., noiseLevel 0.1)" << Qt::endl;
     *m_out << Qt::endl;
+    *m_out << "Recording Commands:" << Qt::endl;
+    *m_out << "  record <file>                Record the source to a raw float32 file" << Qt::endl;
+    *m_out << "  record stop                  Stop recording" << Qt::endl;
+    *m_out << "  record                       Show recording progress and write latency" << Qt::endl;
+    *m_out << Qt::endl;
+    *m_out << "Tracing Commands (builds with SCP_WITH_TRACING):" << Qt::endl;
+    *m_out << "  trace <file>                 Write a Chrome trace of recent pipeline activity" << Qt::endl;
+    *m_out << "  trace clear                  Discard the events recorded so far" << Qt::endl;
+    *m_out << Qt::endl;
     *m_out << "Info Commands:" << Qt::endl;
     *m_out << "  status                       Show current scope status" << Qt::endl;
+    *m_out << "  status --perf                Status followed by the perf statistics" << Qt::endl;
+    *m_out << "  perf                         Show throughput, drops and latency of the pipeline" << Qt::endl;
+    *m_out << "  perf reset                   Restart the perf statistics from zero" << Qt::endl;
     *m_out << "  help | ?                     Show this help" << Qt::endl;
     *m_out << Qt::endl;
     m_out->flush();
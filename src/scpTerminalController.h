@@ -6,6 +6,8 @@
 
 class QTextStream;
 class scpView;
+class scpStreamRecorder;
+class scpThroughputMonitor;
 
 /**
  * @brief Controller for terminal-based oscilloscope commands
@@ -44,6 +46,13 @@ public:
     // Timer management for sampleFor command
     QTimer* sampleForTimer() const { return m_sampleForTimer; }
 
+    // Recorder driven by the record command
+    scpStreamRecorder* recorder() const { return m_recorder; }
+
+    // App-wide statistics shown by the perf command (not owned)
+    void setThroughputMonitor(scpThroughputMonitor* monitor) { m_monitor = monitor; }
+    scpThroughputMonitor* throughputMonitor() const { return m_monitor; }
+
 signals:
     void quitRequested();
     void startRequested();
@@ -67,7 +76,10 @@ private:
     bool handleOffset(const QString& arg);
     bool handleWaveform(const QString& arg);
     bool handleNoiseLevel(const QString& arg);
+    bool handleRecord(const QString& arg);
+    bool handleTrace(const QString& arg);
     bool handleStatus(const QString& arg);
+    bool handlePerf(const QString& arg);
     bool handleHelp(const QString& arg);
 
     // Helper methods
@@ -82,5 +94,7 @@ private:
     QTextStream* m_out = nullptr;
     QTimer* m_sampleForTimer = nullptr;
     int m_sampleForDurationMs = 0;
+    scpStreamRecorder* m_recorder = nullptr;
+    scpThroughputMonitor* m_monitor = nullptr;
 };
 
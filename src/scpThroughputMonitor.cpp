@@ -8,10 +8,6 @@ scpThroughputMonitor::scpThroughputMonitor(QObject* parent)
     , m_timer(new QTimer(this))
     , m_updateIntervalMs(1000)  // Update every second
     , m_sampleSizeBytes(4)  // Assume 4 bytes per sample (float)
-    , m_totalBytesRead(0)
-    , m_totalBytesWritten(0)
-    , m_totalSamples(0)
-    , m_totalDropped(0)
     , m_lastBytesRead(0)
     , m_lastBytesWritten(0)
     , m_lastSamples(0)
@@ -45,45 +41,81 @@ void scpThroughputMonitor::stop() {
     }
 }
 
+scpThroughputMonitor::CounterShard& scpThroughputMonitor::localShard() {
+    // Threads are dealt shards round-robin on first use; the slot is shared by all monitors
+    static std::atomic<int> nextShard{0};
+    thread_local const int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return m_shards[shard];
+}
+
+qint64 scpThroughputMonitor::sum(std::atomic<qint64> CounterShard::*counter) const {
+    qint64 total = 0;
+    for (const CounterShard& shard : m_shards) {
+        total += (shard.*counter).load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
 void scpThroughputMonitor::recordBytesRead(int bytes) {
-    QMutexLocker lock(&m_mutex);
-    m_totalBytesRead += bytes;
+    localShard().bytesRead.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void scpThroughputMonitor::recordBytesWritten(int bytes) {
-    QMutexLocker lock(&m_mutex);
-    m_totalBytesWritten += bytes;
+    localShard().bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void scpThroughputMonitor::recordSamples(int count) {
-    QMutexLocker lock(&m_mutex);
-    m_totalSamples += count;
+    localShard().samples.fetch_add(count, std::memory_order_relaxed);
 }
 
 void scpThroughputMonitor::recordDropped(int count) {
-    QMutexLocker lock(&m_mutex);
-    m_totalDropped += count;
+    localShard().dropped.fetch_add(count, std::memory_order_relaxed);
+}
+
+void scpThroughputMonitor::recordFramesLost(int count) {
+    localShard().framesLost.fetch_add(count, std::memory_order_relaxed);
 }
 
 void scpThroughputMonitor::recordLatency(int microseconds) {
+    m_latency.record(microseconds);
+}
+
+scpLatencyHistogram::Summary scpThroughputMonitor::intervalLatency() const {
     QMutexLocker lock(&m_mutex);
-    m_latencyHistory.enqueue(microseconds);
-    while (m_latencyHistory.size() > MAX_LATENCY_HISTORY) {
-        m_latencyHistory.dequeue();
-    }
+    return m_intervalLatency;
+}
+
+scpLatencyHistogram::Summary scpThroughputMonitor::totalLatency() const {
+    QMutexLocker lock(&m_mutex);
+    return m_totalLatency;
+}
+
+// One line of latency percentiles, e.g. for getStatisticsString()
+static QString formatLatency(const QString& label, const scpLatencyHistogram::Summary& s) {
+    return QString("%1: p50 %2  p90 %3  p99 %4  p99.9 %5  max %6 μs  (n=%7)\n")
+           .arg(label)
+           .arg(s.p50).arg(s.p90).arg(s.p99).arg(s.p999).arg(s.max)
+           .arg(s.count);
 }
 
 void scpThroughputMonitor::reset() {
     QMutexLocker lock(&m_mutex);
-    m_totalBytesRead = 0;
-    m_totalBytesWritten = 0;
-    m_totalSamples = 0;
-    m_totalDropped = 0;
+    // Counts recorded concurrently with a reset may land on either side of it
+    for (CounterShard& shard : m_shards) {
+        shard.bytesRead.store(0, std::memory_order_relaxed);
+        shard.bytesWritten.store(0, std::memory_order_relaxed);
+        shard.samples.store(0, std::memory_order_relaxed);
+        shard.dropped.store(0, std::memory_order_relaxed);
+        shard.framesLost.store(0, std::memory_order_relaxed);
+    }
     m_lastBytesRead = 0;
     m_lastBytesWritten = 0;
     m_lastSamples = 0;
     m_lastDropped = 0;
-    m_latencyHistory.clear();
+    m_latency.reset();
+    m_lastLatency = scpLatencyHistogram::Snapshot();
+    m_intervalLatency = scpLatencyHistogram::Summary();
+    m_totalLatency = scpLatencyHistogram::Summary();
     m_currentBytesPerSecondRead = 0.0;
     m_currentBytesPerSecondWrite = 0.0;
     m_currentSamplesPerSecond = 0.0;
@@ -92,30 +124,41 @@ void scpThroughputMonitor::reset() {
 }
 
 QString scpThroughputMonitor::getStatisticsString() const {
+    const qint64 totalBytesRead = this->totalBytesRead();
+    const qint64 totalBytesWritten = this->totalBytesWritten();
+    const qint64 totalSamples = this->totalSamples();
+    const qint64 totalDropped = this->totalDropped();
+    const qint64 totalFramesLost = this->totalFramesLost();
     QMutexLocker lock(&m_mutex);
     
     QString stats;
     stats += QString("=== Throughput Statistics ===\n");
     stats += QString("Read:  %1 bytes/sec  (total: %2 bytes)\n")
              .arg(m_currentBytesPerSecondRead, 0, 'f', 1)
-             .arg(m_totalBytesRead);
+             .arg(totalBytesRead);
     stats += QString("Write: %1 bytes/sec  (total: %2 bytes)\n")
              .arg(m_currentBytesPerSecondWrite, 0, 'f', 1)
-             .arg(m_totalBytesWritten);
+             .arg(totalBytesWritten);
     stats += QString("Samples: %1 samples/sec  (total: %2)\n")
              .arg(m_currentSamplesPerSecond, 0, 'f', 1)
-             .arg(m_totalSamples);
+             .arg(totalSamples);
     
-    if (m_totalSamples > 0) {
+    if (totalSamples > 0) {
         double dropPercent = (m_currentDropRate * 100.0);
-        stats += QString("Drop Rate: %1%%  (dropped: %2)\n")
+        stats += QString("Drop Rate: %1%  (dropped: %2)\n")
                  .arg(dropPercent, 0, 'f', 2)
-                 .arg(m_totalDropped);
+                 .arg(totalDropped);
+    }
+    
+    if (totalFramesLost > 0) {
+        stats += QString("Lost Frames: %1\n").arg(totalFramesLost);
     }
     
-    if (!m_latencyHistory.isEmpty()) {
+    if (m_totalLatency.count > 0) {
         stats += QString("Avg Latency: %1 μs\n")
                  .arg(m_currentAvgLatency, 0, 'f', 1);
+        stats += formatLatency("Latency (interval)", m_intervalLatency);
+        stats += formatLatency("Latency (total)", m_totalLatency);
     }
     
     return stats;
@@ -128,6 +171,13 @@ void scpThroughputMonitor::onUpdateTimer() {
 }
 
 void scpThroughputMonitor::calculateStatistics() {
+    // Aggregate the shards once per update, outside the lock
+    const qint64 totalBytesRead = this->totalBytesRead();
+    const qint64 totalBytesWritten = this->totalBytesWritten();
+    const qint64 totalSamples = this->totalSamples();
+    const qint64 totalDropped = this->totalDropped();
+    const scpLatencyHistogram::Snapshot latency = m_latency.snapshot();
+    const qint64 intervalMaxLatency = m_latency.takeIntervalMax();
     QMutexLocker lock(&m_mutex);
     
     qint64 currentTime = m_elapsedTimer.elapsed();
@@ -138,10 +188,10 @@ void scpThroughputMonitor::calculateStatistics() {
     double timeDeltaSec = timeDelta / 1000.0;
     
     // Calculate rates
-    qint64 bytesReadDelta = m_totalBytesRead - m_lastBytesRead;
-    qint64 bytesWrittenDelta = m_totalBytesWritten - m_lastBytesWritten;
-    qint64 samplesDelta = m_totalSamples - m_lastSamples;
-    qint64 droppedDelta = m_totalDropped - m_lastDropped;
+    qint64 bytesReadDelta = totalBytesRead - m_lastBytesRead;
+    qint64 bytesWrittenDelta = totalBytesWritten - m_lastBytesWritten;
+    qint64 samplesDelta = totalSamples - m_lastSamples;
+    qint64 droppedDelta = totalDropped - m_lastDropped;
     
     m_currentBytesPerSecondRead = bytesReadDelta / timeDeltaSec;
     m_currentBytesPerSecondWrite = bytesWrittenDelta / timeDeltaSec;
@@ -155,22 +205,19 @@ void scpThroughputMonitor::calculateStatistics() {
         m_currentDropRate = 0.0;
     }
     
-    // Calculate average latency
-    if (!m_latencyHistory.isEmpty()) {
-        qint64 sum = 0;
-        for (int latency : m_latencyHistory) {
-            sum += latency;
-        }
-        m_currentAvgLatency = static_cast<double>(sum) / m_latencyHistory.size();
-    } else {
-        m_currentAvgLatency = 0.0;
-    }
+    // Latency percentiles: the interval is the difference to the previous snapshot
+    scpLatencyHistogram::Snapshot interval = latency.since(m_lastLatency);
+    interval.max = intervalMaxLatency;
+    m_intervalLatency = interval.summary();
+    m_totalLatency = latency.summary();
+    m_currentAvgLatency = m_intervalLatency.mean;
+    m_lastLatency = latency;
     
     // Update last values
-    m_lastBytesRead = m_totalBytesRead;
-    m_lastBytesWritten = m_totalBytesWritten;
-    m_lastSamples = m_totalSamples;
-    m_lastDropped = m_totalDropped;
+    m_lastBytesRead = totalBytesRead;
+    m_lastBytesWritten = totalBytesWritten;
+    m_lastSamples = totalSamples;
+    m_lastDropped = totalDropped;
     m_lastUpdateTime = currentTime;
 }
 
@@ -187,7 +234,7 @@ void scpThroughputMonitor::checkAlerts() {
     // Check drop rate alert
     if (m_currentDropRate > m_maxDropRate) {
         emit dropRateAlert(m_currentDropRate,
-                          QString("High drop rate detected: %1%%").arg(m_currentDropRate * 100.0, 0, 'f', 2));
+                          QString("High drop rate detected: %1%").arg(m_currentDropRate * 100.0, 0, 'f', 2));
     }
 }
 
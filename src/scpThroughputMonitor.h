@@ -2,8 +2,9 @@
 #include <QObject>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <QQueue>
 #include <QMutex>
+#include <atomic>
+#include "scpLatencyHistogram.h"
 
 /**
  * @brief Monitors throughput and performance metrics
@@ -16,6 +17,14 @@
  * - Buffer utilization
  * 
  * Provides real-time statistics and alerts on performance issues.
+ *
+ * The byte, sample, drop and frame counters are sharded: each recording
+ * thread adds to its own cache-line-sized shard with a relaxed atomic, so
+ * producers on different threads never share a lock or a cache line.
+ * Shards are summed only when totals or rates are read.
+ *
+ * Latencies go into a lock-free log-bucketed histogram. Each update
+ * reports p50/p90/p99/p99.9/max for the last interval and since start.
  */
 class scpThroughputMonitor : public QObject {
     Q_OBJECT
@@ -42,6 +51,7 @@ public:
     void recordSamples(int count);
     void recordDropped(int count);
     void recordLatency(int microseconds);
+    void recordFramesLost(int count);
 
     // Statistics (current values)
     double bytesPerSecondRead() const { return m_currentBytesPerSecondRead; }
@@ -50,11 +60,18 @@ public:
     double dropRate() const { return m_currentDropRate; }
     double averageLatency() const { return m_currentAvgLatency; }
 
+    // Latency distribution (us) of the last update interval and since start
+    scpLatencyHistogram::Summary intervalLatency() const;
+    scpLatencyHistogram::Summary totalLatency() const;
+    // Raw buckets since start, e.g. for export as a Prometheus histogram
+    scpLatencyHistogram::Snapshot latencySnapshot() const { return m_latency.snapshot(); }
+
     // Cumulative statistics (since start)
-    qint64 totalBytesRead() const { return m_totalBytesRead; }
-    qint64 totalBytesWritten() const { return m_totalBytesWritten; }
-    qint64 totalSamples() const { return m_totalSamples; }
-    qint64 totalDropped() const { return m_totalDropped; }
+    qint64 totalBytesRead() const { return sum(&CounterShard::bytesRead); }
+    qint64 totalBytesWritten() const { return sum(&CounterShard::bytesWritten); }
+    qint64 totalSamples() const { return sum(&CounterShard::samples); }
+    qint64 totalDropped() const { return sum(&CounterShard::dropped); }
+    qint64 totalFramesLost() const { return sum(&CounterShard::framesLost); }
 
     // Reset statistics
     void reset();
@@ -71,6 +88,18 @@ private slots:
     void onUpdateTimer();
 
 private:
+    // One cache line of counters per recording thread (threads beyond kShards share)
+    static constexpr int kShards = 16;
+    struct alignas(64) CounterShard {
+        std::atomic<qint64> bytesRead{0};
+        std::atomic<qint64> bytesWritten{0};
+        std::atomic<qint64> samples{0};
+        std::atomic<qint64> dropped{0};
+        std::atomic<qint64> framesLost{0};  // Sequence gaps reported by a framed reader
+    };
+
+    CounterShard& localShard();
+    qint64 sum(std::atomic<qint64> CounterShard::*counter) const;
     void calculateStatistics();
     void checkAlerts();
 
@@ -79,14 +108,15 @@ private:
     int m_updateIntervalMs;
     int m_sampleSizeBytes;
 
-    // Counters (protected by mutex)
+    CounterShard m_shards[kShards];
+
+    scpLatencyHistogram m_latency;
+
+    // Derived values (protected by mutex)
     mutable QMutex m_mutex;
-    qint64 m_totalBytesRead;
-    qint64 m_totalBytesWritten;
-    qint64 m_totalSamples;
-    qint64 m_totalDropped;
-    QQueue<int> m_latencyHistory;  // Recent latency measurements in microseconds
-    static const int MAX_LATENCY_HISTORY = 100;
+    scpLatencyHistogram::Snapshot m_lastLatency;  // Histogram at the previous update
+    scpLatencyHistogram::Summary m_intervalLatency;
+    scpLatencyHistogram::Summary m_totalLatency;
 
     // Time tracking
     qint64 m_lastBytesRead;
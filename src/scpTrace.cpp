@@ -0,0 +1,183 @@
+#include "scpTrace.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef SCP_ENABLE_TRACING
+
+namespace {
+
+struct Event {
+    const char* name;
+    qint64 startNs;
+    qint64 endNs;
+};
+
+struct ThreadBuffer {
+    std::unique_ptr<Event[]> events{new Event[scpTracer::kEventsPerThread]};
+    std::atomic<quint64> count{0};    // Events ever recorded; written by the owning thread only
+    std::atomic<quint64> cleared{0};  // Events below this index were discarded by clear()
+    std::atomic<bool> inUse{false};
+    char threadName[48] = {};         // Guarded by the registry mutex
+    int tid = 0;                      // Likewise; fresh for every thread that leases the ring
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    int lastTid = 0;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Releases the ring for reuse when its thread exits
+struct BufferLease {
+    ThreadBuffer* buffer = nullptr;
+    ~BufferLease() {
+        if (buffer) buffer->inUse.store(false, std::memory_order_release);
+    }
+};
+
+thread_local BufferLease t_lease;
+
+ThreadBuffer* localBuffer() {
+    if (t_lease.buffer) return t_lease.buffer;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const std::unique_ptr<ThreadBuffer>& b : reg.buffers) {
+        bool expected = false;
+        if (b->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            // Nothing of the exited thread may show up under the new one
+            b->cleared.store(b->count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            b->threadName[0] = '\0';
+            b->tid = ++reg.lastTid;
+            t_lease.buffer = b.get();
+            return b.get();
+        }
+    }
+    reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer* b = reg.buffers.back().get();
+    b->tid = ++reg.lastTid;
+    b->inUse.store(true, std::memory_order_relaxed);
+    t_lease.buffer = b;
+    return b;
+}
+
+void appendJsonString(QByteArray& out, const char* text) {
+    out += '"';
+    for (const char* p = text; *p; ++p) {
+        const char c = *p;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+}  // namespace
+
+void scpTracer::record(const char* name, qint64 startNs, qint64 endNs) {
+    ThreadBuffer* b = localBuffer();
+    const quint64 n = b->count.load(std::memory_order_relaxed);
+    b->events[n % kEventsPerThread] = Event{name, startNs, endNs};
+    b->count.store(n + 1, std::memory_order_release);
+}
+
+void scpTracer::setThreadName(const char* name) {
+    ThreadBuffer* b = localBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    std::strncpy(b->threadName, name, sizeof(b->threadName) - 1);
+    b->threadName[sizeof(b->threadName) - 1] = '\0';
+}
+
+void scpTracer::clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const std::unique_ptr<ThreadBuffer>& b : reg.buffers) {
+        b->cleared.store(b->count.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool scpTracer::writeChromeTrace(const QString& path, QString* error) {
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&json, &first]() {
+        if (!first) json += ",\n";
+        first = false;
+    };
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<Event> events;
+    for (const std::unique_ptr<ThreadBuffer>& b : reg.buffers) {
+        // Copy the ring, then drop whatever the owner overwrote while we were copying
+        const quint64 end = b->count.load(std::memory_order_acquire);
+        const quint64 cap = kEventsPerThread;
+        quint64 begin = std::max(b->cleared.load(std::memory_order_relaxed), end > cap ? end - cap : 0);
+        events.clear();
+        for (quint64 i = begin; i < end; ++i) {
+            events.push_back(b->events[i % cap]);
+        }
+        const quint64 after = b->count.load(std::memory_order_acquire);
+        // The slot of index 'after' may be mid-write too, hence the + 1
+        const quint64 safeBegin = after >= cap ? after - cap + 1 : 0;
+        const size_t skip = safeBegin > begin ? static_cast<size_t>(std::min(safeBegin - begin, end - begin)) : 0;
+
+        separator();
+        json += QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":")
+                .arg(pid).arg(b->tid).toUtf8();
+        const QByteArray fallback = QString("thread %1").arg(b->tid).toUtf8();
+        appendJsonString(json, b->threadName[0] ? b->threadName : fallback.constData());
+        json += "}}";
+
+        for (size_t i = skip; i < events.size(); ++i) {
+            const Event& e = events[i];
+            separator();
+            json += "{\"name\":";
+            appendJsonString(json, e.name);
+            // Chrome trace timestamps are microseconds
+            json += QString(",\"cat\":\"scope\",\"ph\":\"X\",\"ts\":%1,\"dur\":%2,\"pid\":%3,\"tid\":%4}")
+                    .arg(e.startNs / 1000.0, 0, 'f', 3)
+                    .arg((e.endNs - e.startNs) / 1000.0, 0, 'f', 3)
+                    .arg(pid).arg(b->tid).toUtf8();
+        }
+    }
+    json += "\n]}\n";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        if (error) *error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+#else  // SCP_ENABLE_TRACING
+
+void scpTracer::record(const char*, qint64, qint64) {}
+
+void scpTracer::setThreadName(const char*) {}
+
+void scpTracer::clear() {}
+
+bool scpTracer::writeChromeTrace(const QString& path, QString* error) {
+    Q_UNUSED(path);
+    if (error) *error = "Tracing is not compiled in (configure with -DSCP_WITH_TRACING=ON)";
+    return false;
+}
+
+#endif  // SCP_ENABLE_TRACING
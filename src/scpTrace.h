@@ -0,0 +1,66 @@
+#pragma once
+#include <QString>
+#include "scpLatencyHistogram.h"
+
+/**
+ * @brief Scoped trace points exported as Chrome trace JSON
+ *
+ * SCP_TRACE_SCOPE("name") records one complete event spanning the rest of
+ * the enclosing scope. Each thread writes into its own ring of
+ * kEventsPerThread events: only that thread writes to it, so a trace point
+ * costs two clock reads and a few plain stores, with no lock and no atomic
+ * read-modify-write. The newest events of each thread are kept; rings of
+ * finished threads are handed to the next new thread.
+ *
+ * writeChromeTrace() dumps every ring to a file that chrome://tracing and
+ * ui.perfetto.dev open as a per-thread timeline.
+ *
+ * Tracing is compiled in only when SCP_ENABLE_TRACING is defined (CMake
+ * option SCP_WITH_TRACING). Otherwise the macros expand to nothing and
+ * writeChromeTrace() fails with an explanation.
+ *
+ * Event names must be string literals: only the pointer is stored.
+ */
+class scpTracer {
+public:
+    static constexpr int kEventsPerThread = 1 << 15;
+
+    static constexpr bool compiledIn() {
+#ifdef SCP_ENABLE_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void record(const char* name, qint64 startNs, qint64 endNs);
+    // Label for the calling thread in the timeline (copied)
+    static void setThreadName(const char* name);
+
+    static bool writeChromeTrace(const QString& path, QString* error = nullptr);
+    // Forget everything recorded so far
+    static void clear();
+};
+
+class scpTraceScope {
+public:
+    explicit scpTraceScope(const char* name) : m_name(name), m_startNs(scpMonotonicNs()) {}
+    ~scpTraceScope() { scpTracer::record(m_name, m_startNs, scpMonotonicNs()); }
+
+    scpTraceScope(const scpTraceScope&) = delete;
+    scpTraceScope& operator=(const scpTraceScope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startNs;
+};
+
+#ifdef SCP_ENABLE_TRACING
+#define SCP_TRACE_CONCAT_(a, b) a##b
+#define SCP_TRACE_CONCAT(a, b) SCP_TRACE_CONCAT_(a, b)
+#define SCP_TRACE_SCOPE(name) scpTraceScope SCP_TRACE_CONCAT(scpTraceScope_, __LINE__)(name)
+#define SCP_TRACE_THREAD_NAME(name) scpTracer::setThreadName(name)
+#else
+#define SCP_TRACE_SCOPE(name) ((void)0)
+#define SCP_TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,451 @@
+#include "scpUringIO.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#ifdef SCP_HAVE_IO_URING
+#include <liburing.h>
+#include <sys/uio.h>
+#endif
+
+// Registered buffers are page aligned and a whole number of pages long
+static constexpr int kBufferAlignment = 4096;
+
+#ifdef SCP_HAVE_IO_URING
+static int roundUpToPage(int bytes) {
+    return (bytes + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+static char* allocBuffer(int bytes) {
+    void* p = nullptr;
+    if (posix_memalign(&p, kBufferAlignment, static_cast<size_t>(bytes)) != 0) return nullptr;
+    return static_cast<char*>(p);
+}
+
+static QString uringError(int negErrno) {
+    return QString::fromLocal8Bit(strerror(-negErrno));
+}
+
+// Creates a ring of `depth` entries with one registered buffer per entry
+static io_uring* createRing(int depth, int blockSize, std::vector<char*>& buffers, QString& error) {
+    io_uring* ring = new io_uring;
+    int rc = io_uring_queue_init(static_cast<unsigned>(depth), ring, 0);
+    if (rc < 0) {
+        error = QString("io_uring_queue_init failed: %1").arg(uringError(rc));
+        delete ring;
+        return nullptr;
+    }
+
+    std::vector<iovec> iovecs(depth);
+    buffers.assign(depth, nullptr);
+    for (int i = 0; i < depth; ++i) {
+        buffers[i] = allocBuffer(blockSize);
+        if (!buffers[i]) {
+            rc = -ENOMEM;
+            break;
+        }
+        iovecs[i].iov_base = buffers[i];
+        iovecs[i].iov_len = static_cast<size_t>(blockSize);
+    }
+    if (rc >= 0) {
+        rc = io_uring_register_buffers(ring, iovecs.data(), static_cast<unsigned>(depth));
+    }
+    if (rc < 0) {
+        error = QString("io_uring buffer registration failed: %1").arg(uringError(rc));
+        io_uring_queue_exit(ring);
+        delete ring;
+        for (char* b : buffers) free(b);
+        buffers.clear();
+        return nullptr;
+    }
+    return ring;
+}
+
+// Leaves the buffers to the caller, which may still have them handed out
+static void destroyRing(io_uring* ring) {
+    io_uring_unregister_buffers(ring);
+    io_uring_queue_exit(ring);
+    delete ring;
+}
+#endif
+
+// ============================================================================
+// scpUringFileReader
+// ============================================================================
+
+scpUringFileReader::BufferPool::~BufferPool() {
+    for (char* b : buffers) free(b);
+}
+
+scpUringFileReader::scpUringFileReader()
+    : m_ring(nullptr)
+    , m_head(0)
+    , m_tail(0)
+    , m_fd(-1)
+    , m_nextOffset(0)
+    , m_fileSize(0)
+    , m_blockSize(0)
+    , m_loop(false)
+{
+}
+
+scpUringFileReader::~scpUringFileReader() {
+    close();
+}
+
+bool scpUringFileReader::isAvailable() {
+#ifdef SCP_HAVE_IO_URING
+    // Kernels without io_uring (or with it disabled by policy) fail here
+    io_uring probe;
+    if (io_uring_queue_init(1, &probe, 0) < 0) return false;
+    io_uring_queue_exit(&probe);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool scpUringFileReader::open(int fd, qint64 startOffset, qint64 fileSize, int blockSize, int depth, bool loop) {
+    close();
+#ifdef SCP_HAVE_IO_URING
+    if (fd < 0 || fileSize <= 0 || blockSize <= 0 || depth <= 0) {
+        m_error = "Invalid io_uring reader parameters";
+        return false;
+    }
+
+    m_blockSize = roundUpToPage(blockSize);
+    auto pool = std::make_shared<BufferPool>();
+    m_ring = createRing(depth, m_blockSize, pool->buffers, m_error);
+    if (!m_ring) return false;
+    pool->released.reset(new std::atomic<bool>[depth]());
+    m_pool = std::move(pool);
+
+    m_slots.assign(depth, Slot());
+    for (int i = 0; i < depth; ++i) m_slots[i].buffer = m_pool->buffers[i];
+    m_head = 0;
+    m_tail = 0;
+    m_fd = fd;
+    m_nextOffset = std::clamp<qint64>(startOffset, 0, fileSize);
+    m_fileSize = fileSize;
+    m_loop = loop;
+
+    // Fill the pipeline; a short file may not need every slot
+    for (int i = 0; i < depth; ++i) {
+        const int rc = submit(i);
+        if (rc < 0) {
+            close();
+            return false;
+        }
+        if (rc == 0) break;
+    }
+    return true;
+#else
+    Q_UNUSED(fd);
+    Q_UNUSED(startOffset);
+    Q_UNUSED(fileSize);
+    Q_UNUSED(blockSize);
+    Q_UNUSED(depth);
+    Q_UNUSED(loop);
+    m_error = "io_uring support not built";
+    return false;
+#endif
+}
+
+void scpUringFileReader::close() {
+#ifdef SCP_HAVE_IO_URING
+    if (!m_ring) return;
+
+    // Buffers must not be freed under reads the kernel still owns
+    for (const Slot& s : m_slots) {
+        while (s.inFlight && !s.done) {
+            io_uring_cqe* cqe = nullptr;
+            if (io_uring_wait_cqe(m_ring, &cqe) < 0) break;
+            const int index = static_cast<int>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+            m_slots[index].done = true;
+            io_uring_cqe_seen(m_ring, cqe);
+        }
+    }
+
+    destroyRing(m_ring);
+    m_ring = nullptr;
+    m_slots.clear();
+    m_pool.reset();  // Buffers still leased out are freed with the last lease
+#endif
+}
+
+int scpUringFileReader::submit(int index) {
+#ifdef SCP_HAVE_IO_URING
+    if (m_nextOffset >= m_fileSize) {
+        if (!m_loop) return 0;
+        m_nextOffset = 0;
+    }
+
+    Slot& s = m_slots[index];
+    s.offset = m_nextOffset;
+    s.length = static_cast<int>(std::min<qint64>(m_blockSize, m_fileSize - m_nextOffset));
+    s.filled = 0;
+    const int rc = submitRead(index);
+    // The next slot starts after the whole block: a short read is completed in place
+    if (rc > 0) m_nextOffset += s.length;
+    return rc;
+#else
+    Q_UNUSED(index);
+    return -1;
+#endif
+}
+
+// Reads the part of a slot's block that is not filled yet
+int scpUringFileReader::submitRead(int index) {
+#ifdef SCP_HAVE_IO_URING
+    io_uring_sqe* sqe = io_uring_get_sqe(m_ring);
+    if (!sqe) {
+        m_error = "io_uring submission queue full";
+        return -1;
+    }
+
+    Slot& s = m_slots[index];
+    s.result = 0;
+    s.done = false;
+    io_uring_prep_read_fixed(sqe, m_fd, s.buffer + s.filled, static_cast<unsigned>(s.length - s.filled),
+                             static_cast<__u64>(s.offset + s.filled), index);
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(index)));
+    const int rc = io_uring_submit(m_ring);
+    if (rc < 0) {
+        m_error = QString("io_uring_submit failed: %1").arg(uringError(rc));
+        return -1;
+    }
+    s.inFlight = true;
+    return 1;
+#else
+    Q_UNUSED(index);
+    return -1;
+#endif
+}
+
+// Reads into released buffers again, oldest first so blocks stay in file order
+bool scpUringFileReader::reclaim() {
+    const int depth = static_cast<int>(m_slots.size());
+    while (m_slots[m_tail].leased && m_pool->released[m_tail].load(std::memory_order_acquire)) {
+        m_slots[m_tail].leased = false;
+        m_pool->released[m_tail].store(false, std::memory_order_relaxed);
+        if (submit(m_tail) < 0) return false;
+        m_tail = (m_tail + 1) % depth;
+    }
+    return true;
+}
+
+bool scpUringFileReader::ready() const {
+    if (!m_ring) return true;
+    // Leased slots run from m_tail up to m_head, so a leased head means all of them are
+    return !m_slots[m_head].leased || m_pool->released[m_head].load(std::memory_order_acquire);
+}
+
+qint64 scpUringFileReader::next(QByteArray& out, std::shared_ptr<void>& lease) {
+    out.clear();
+    lease.reset();
+#ifdef SCP_HAVE_IO_URING
+    if (!m_ring) return -1;
+    if (!reclaim()) return -1;
+
+    Slot& s = m_slots[m_head];
+    if (s.leased) {
+        m_error = "Every io_uring buffer is still leased out";
+        return -1;
+    }
+    // Slots are delivered in submission order, so an idle head means nothing is left
+    if (!s.inFlight) return 0;
+
+    for (;;) {
+        while (!s.done) {
+            io_uring_cqe* cqe = nullptr;
+            const int rc = io_uring_wait_cqe(m_ring, &cqe);
+            if (rc == -EINTR) continue;
+            if (rc < 0) {
+                m_error = QString("io_uring_wait_cqe failed: %1").arg(uringError(rc));
+                return -1;
+            }
+            const int index = static_cast<int>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+            m_slots[index].result = cqe->res;
+            m_slots[index].done = true;
+            io_uring_cqe_seen(m_ring, cqe);
+        }
+
+        s.inFlight = false;
+        if (s.result < 0) {
+            m_error = QString("Read failed: %1").arg(uringError(s.result));
+            return -1;
+        }
+        s.filled += s.result;
+        // Nothing more means the file shrank: deliver what is there
+        if (s.result == 0 || s.filled >= s.length) break;
+        if (submitRead(m_head) < 0) return -1;
+    }
+
+    const qint64 n = s.filled;
+    if (n == 0) return 0;
+
+    // Hand out the buffer itself; releasing the lease puts the slot back into the pipeline
+    const int index = m_head;
+    s.leased = true;
+    out = QByteArray::fromRawData(s.buffer, static_cast<qsizetype>(n));
+    lease = std::shared_ptr<void>(nullptr, [pool = m_pool, index](void*) {
+        pool->released[index].store(true, std::memory_order_release);
+    });
+    m_head = (m_head + 1) % static_cast<int>(m_slots.size());
+    return n;
+#else
+    return -1;
+#endif
+}
+
+// ============================================================================
+// scpUringFileWriter
+// ============================================================================
+
+scpUringFileWriter::scpUringFileWriter()
+    : m_ring(nullptr)
+    , m_acquired(-1)
+    , m_inFlight(0)
+    , m_fd(-1)
+    , m_nextOffset(0)
+    , m_blockSize(0)
+{
+}
+
+scpUringFileWriter::~scpUringFileWriter() {
+    close();
+}
+
+bool scpUringFileWriter::open(int fd, qint64 startOffset, int blockSize, int depth) {
+    close();
+#ifdef SCP_HAVE_IO_URING
+    if (fd < 0 || blockSize <= 0 || depth <= 0) {
+        m_error = "Invalid io_uring writer parameters";
+        return false;
+    }
+
+    m_blockSize = roundUpToPage(blockSize);
+    m_ring = createRing(depth, m_blockSize, m_buffers, m_error);
+    if (!m_ring) return false;
+
+    m_lengths.assign(depth, 0);
+    m_free.clear();
+    for (int i = depth - 1; i >= 0; --i) m_free.push_back(i);
+    m_acquired = -1;
+    m_inFlight = 0;
+    m_fd = fd;
+    m_nextOffset = startOffset;
+    return true;
+#else
+    Q_UNUSED(fd);
+    Q_UNUSED(startOffset);
+    Q_UNUSED(blockSize);
+    Q_UNUSED(depth);
+    m_error = "io_uring support not built";
+    return false;
+#endif
+}
+
+void scpUringFileWriter::close() {
+#ifdef SCP_HAVE_IO_URING
+    if (!m_ring) return;
+    drain();
+    destroyRing(m_ring);
+    for (char* b : m_buffers) free(b);
+    m_buffers.clear();
+    m_ring = nullptr;
+    m_free.clear();
+    m_lengths.clear();
+    m_acquired = -1;
+#endif
+}
+
+char* scpUringFileWriter::acquire() {
+    if (!m_ring) return nullptr;
+    if (m_acquired < 0) {
+        if (m_free.empty()) return nullptr;
+        m_acquired = m_free.back();
+        m_free.pop_back();
+    }
+    return m_buffers[m_acquired];
+}
+
+bool scpUringFileWriter::submit(int length) {
+#ifdef SCP_HAVE_IO_URING
+    if (!m_ring || m_acquired < 0 || length <= 0 || length > m_blockSize) return false;
+
+    io_uring_sqe* sqe = io_uring_get_sqe(m_ring);
+    if (!sqe) return false;
+
+    const int index = m_acquired;
+    io_uring_prep_write_fixed(sqe, m_fd, m_buffers[index], static_cast<unsigned>(length),
+                              static_cast<__u64>(m_nextOffset), index);
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(index)));
+    const int rc = io_uring_submit(m_ring);
+    if (rc < 0) {
+        m_error = QString("io_uring_submit failed: %1").arg(uringError(rc));
+        return false;
+    }
+
+    m_lengths[index] = length;
+    m_nextOffset += length;
+    m_acquired = -1;
+    ++m_inFlight;
+    return true;
+#else
+    Q_UNUSED(length);
+    return false;
+#endif
+}
+
+qint64 scpUringFileWriter::reap(bool wait) {
+#ifdef SCP_HAVE_IO_URING
+    if (!m_ring) return -1;
+
+    qint64 bytes = 0;
+    bool failed = false;
+    while (m_inFlight > 0) {
+        io_uring_cqe* cqe = nullptr;
+        // Block for at most the first completion; collect the rest only if already there
+        const int rc = (wait && bytes == 0 && !failed) ? io_uring_wait_cqe(m_ring, &cqe)
+                                                      : io_uring_peek_cqe(m_ring, &cqe);
+        if (rc == -EAGAIN) break;
+        if (rc == -EINTR) continue;
+        if (rc < 0) {
+            m_error = QString("io_uring completion failed: %1").arg(uringError(rc));
+            return -1;
+        }
+
+        const int index = static_cast<int>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+        const int res = cqe->res;
+        io_uring_cqe_seen(m_ring, cqe);
+        --m_inFlight;
+        m_free.push_back(index);
+
+        if (res < 0) {
+            m_error = QString("Write failed: %1").arg(uringError(res));
+            failed = true;
+        } else if (res < m_lengths[index]) {
+            m_error = QString("Short write: %1 of %2 bytes").arg(res).arg(m_lengths[index]);
+            failed = true;
+        } else {
+            bytes += res;
+        }
+    }
+    return failed ? -1 : bytes;
+#else
+    Q_UNUSED(wait);
+    return -1;
+#endif
+}
+
+qint64 scpUringFileWriter::drain() {
+    qint64 total = 0;
+    while (m_ring && m_inFlight > 0) {
+        const qint64 n = reap(true);
+        if (n < 0) return -1;
+        total += n;
+    }
+    return total;
+}
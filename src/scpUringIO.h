@@ -0,0 +1,128 @@
+#ifndef SCPURINGIO_H
+#define SCPURINGIO_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct io_uring;
+
+/**
+ * @brief Pipelined sequential file reader on io_uring
+ *
+ * Keeps `depth` reads of `blockSize` bytes in flight against registered
+ * (fixed) buffers and returns the blocks strictly in file order. Blocks
+ * never straddle the end of the file; with looping enabled reading wraps
+ * to offset 0 instead of ending.
+ *
+ * Blocks are handed out in place: each is a view of its registered buffer,
+ * and the buffer is read into again only once the last copy of the lease
+ * that came with it is gone. Leases and views may outlive the reader.
+ *
+ * Only built when liburing is found (SCP_HAVE_IO_URING); otherwise open()
+ * fails and callers fall back to QFile.
+ */
+class scpUringFileReader {
+public:
+    scpUringFileReader();
+    ~scpUringFileReader();
+    scpUringFileReader(const scpUringFileReader&) = delete;
+    scpUringFileReader& operator=(const scpUringFileReader&) = delete;
+
+    static bool isAvailable();
+
+    bool open(int fd, qint64 startOffset, qint64 fileSize, int blockSize, int depth, bool loop);
+    void close();
+
+    // False while every buffer is still leased out; next() must not be called then
+    bool ready() const;
+    // Next block in file order as a view in out: bytes read, 0 at end of file, -1 on error.
+    // out stays valid while lease (or a copy of it) is held.
+    qint64 next(QByteArray& out, std::shared_ptr<void>& lease);
+
+    int blockSize() const { return m_blockSize; }
+    QString errorString() const { return m_error; }
+
+private:
+    struct Slot {
+        char* buffer = nullptr;
+        qint64 offset = 0;
+        int length = 0;
+        int filled = 0;      // Bytes read so far; a short read resubmits the rest
+        int result = 0;
+        bool inFlight = false;
+        bool done = false;
+        bool leased = false;  // Delivered, waiting for its lease to be released
+    };
+
+    // Registered buffers and their release flags, shared with the leases
+    struct BufferPool {
+        std::vector<char*> buffers;
+        std::unique_ptr<std::atomic<bool>[]> released;
+        ~BufferPool();
+    };
+
+    // 1 submitted, 0 nothing left to read, -1 failed (see errorString())
+    int submit(int index);
+    int submitRead(int index);
+    bool reclaim();
+
+    io_uring* m_ring;
+    std::vector<Slot> m_slots;
+    std::shared_ptr<BufferPool> m_pool;
+    int m_head;              // Oldest slot, the next one to deliver
+    int m_tail;              // Oldest leased slot, the next one to read into again
+    int m_fd;
+    qint64 m_nextOffset;
+    qint64 m_fileSize;
+    int m_blockSize;
+    bool m_loop;
+    QString m_error;
+};
+
+/**
+ * @brief Asynchronous appending file writer on io_uring
+ *
+ * The caller fills a free registered buffer from acquire() and hands it
+ * back with submit(); writes are issued at increasing file offsets and
+ * completions are collected with reap() without blocking the caller.
+ */
+class scpUringFileWriter {
+public:
+    scpUringFileWriter();
+    ~scpUringFileWriter();
+    scpUringFileWriter(const scpUringFileWriter&) = delete;
+    scpUringFileWriter& operator=(const scpUringFileWriter&) = delete;
+
+    bool open(int fd, qint64 startOffset, int blockSize, int depth);
+    // Waits for outstanding writes before releasing the ring
+    void close();
+
+    // Free buffer of blockSize() bytes, or nullptr while all are in flight
+    char* acquire();
+    bool submit(int length);
+    // Completed bytes since the last call, or -1 on a failed write
+    qint64 reap(bool wait);
+    // Blocks until every submitted write has completed
+    qint64 drain();
+
+    int blockSize() const { return m_blockSize; }
+    int inFlight() const { return m_inFlight; }
+    QString errorString() const { return m_error; }
+
+private:
+    io_uring* m_ring;
+    std::vector<char*> m_buffers;
+    std::vector<int> m_lengths;   // Bytes submitted from each buffer
+    std::vector<int> m_free;   // Indices of buffers not in flight
+    int m_acquired;            // Buffer handed out by acquire(), -1 if none
+    int m_inFlight;
+    int m_fd;
+    qint64 m_nextOffset;
+    int m_blockSize;
+    QString m_error;
+};
+
+#endif // SCPURINGIO_H
@@ -1,26 +1,51 @@
 #include "scpUsbReadController.h"
 #include "scpFTDIInterface.h"
+#include "scpThroughputMonitor.h"
 #include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+
+// Default deadline for a partly filled batch
+static constexpr int kDefaultBatchIntervalMs = 10;
+// The reassembly buffer stops accepting data at this many batches (slow consumer)
+static constexpr int kMaxBufferedBatches = 64;
 
 scpUsbReadController::scpUsbReadController(QObject* parent)
     : QObject(parent)
     , m_reader(new scpFTDIReader(this))
+    , m_ioThread(nullptr)
     , m_autoReconnect(true)
     , m_reconnectDelayMs(1000)
     , m_reconnectTimer(new QTimer(this))
+    , m_monitor(nullptr)
+    , m_batchBytes(0)
+    , m_batchIntervalMs(kDefaultBatchIntervalMs)
+    , m_batchAlign(1)
+    , m_batchConnected(false)
+    , m_batchTimer(new QTimer(this))
+    , m_batchReadBytes(0)
+    , m_batchNewestReadNs(0)
+    , m_flushScheduled(false)
+    , m_readsBatched(0)
+    , m_batchOverflowBytes(0)
+    , m_batchesDelivered(0)
     , m_totalBytesRead(0)
+    , m_deliveredReadNs(0)
     , m_errorCount(0)
     , m_reconnectCount(0)
     , m_isConnected(false)
 {
     m_reconnectTimer->setSingleShot(true);
     connect(m_reconnectTimer, &QTimer::timeout, this, &scpUsbReadController::attemptReconnect);
+    m_batchTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_batchTimer, &QTimer::timeout, this, &scpUsbReadController::flushBatch);
+    connect(this, &scpUsbReadController::readForwarded,
+            this, &scpUsbReadController::deliverRead, Qt::QueuedConnection);
 
-    // Forward signals from reader
-    connect(m_reader, &scpFTDIReader::dataReceived,
-            this, &scpUsbReadController::onReaderDataReceived);
-    connect(m_reader, &scpFTDIReader::readCompleted,
-            this, &scpUsbReadController::onReaderReadCompleted);
+    // Forward signals from reader (data signals: see connectReader())
+    connectReader();
+    connect(m_reader, &scpFTDIReader::framesLost,
+            this, &scpUsbReadController::onReaderFramesLost);
     connect(m_reader, &scpFTDIReader::errorOccurred,
             this, &scpUsbReadController::onReaderError);
     connect(m_reader, &scpFTDIReader::statusChanged,
@@ -29,15 +54,49 @@ scpUsbReadController::scpUsbReadController(QObject* parent)
 
 scpUsbReadController::~scpUsbReadController() {
     close();
+    stopIoThread();
+}
+
+void scpUsbReadController::startIoThread(const scpThreadTuning& tuning) {
+    if (m_ioThread) {
+        handleError("I/O thread already running");
+        return;
+    }
+    if (m_reader->isRunning()) {
+        handleError("Cannot move a running reader to an I/O thread");
+        return;
+    }
+
+    // The reader and its timer leave this thread; its signals become queued
+    m_reader->setThreadTuning(tuning);
+    m_ioThread = new scpIoThread("USB read", tuning, this);
+    connect(m_ioThread, &scpIoThread::statusChanged, this, &scpUsbReadController::updateStatus);
+    m_reader->setParent(nullptr);
+    m_reader->moveToThread(m_ioThread);
+    m_ioThread->start(QThread::HighPriority);
+    updateStatus(QString("I/O thread started (%1)").arg(tuning.toString()));
+}
+
+void scpUsbReadController::stopIoThread() {
+    if (!m_ioThread) return;
+    // Only the reader's own thread may hand it back
+    QThread* home = thread();
+    onReaderThread([this, home]() { m_reader->moveToThread(home); });
+    m_ioThread->quit();
+    m_ioThread->wait();
+    delete m_ioThread;
+    m_ioThread = nullptr;
+    m_reader->setParent(this);
+    updateStatus("I/O thread stopped");
 }
 
 void scpUsbReadController::setDevicePath(const QString& path) {
     m_devicePath = path;
-    m_reader->setDevicePath(path);
+    onReaderThread([this, path]() { m_reader->setDevicePath(path); });
 }
 
 void scpUsbReadController::setSamplingFrequency(double frequencyHz) {
-    m_reader->setSamplingFrequency(frequencyHz);
+    onReaderThread([this, frequencyHz]() { m_reader->setSamplingFrequency(frequencyHz); });
 }
 
 double scpUsbReadController::samplingFrequency() const {
@@ -45,13 +104,173 @@ double scpUsbReadController::samplingFrequency() const {
 }
 
 void scpUsbReadController::setBytesPerRead(int bytes) {
-    m_reader->setBytesPerRead(bytes);
+    onReaderThread([this, bytes]() { m_reader->setBytesPerRead(bytes); });
 }
 
 int scpUsbReadController::bytesPerRead() const {
     return m_reader->bytesPerRead();
 }
 
+void scpUsbReadController::setReadMode(scpFTDIReader::ReadMode mode) {
+    onReaderThread([this, mode]() { m_reader->setReadMode(mode); });
+}
+
+scpFTDIReader::ReadMode scpUsbReadController::readMode() const {
+    return m_reader->readMode();
+}
+
+void scpUsbReadController::setTargetThroughput(double bytesPerSec) {
+    onReaderThread([this, bytesPerSec]() { m_reader->setTargetThroughput(bytesPerSec); });
+}
+
+double scpUsbReadController::targetThroughput() const {
+    return m_reader->targetThroughput();
+}
+
+void scpUsbReadController::setMemoryMappedReplay(bool enable) {
+    onReaderThread([this, enable]() { m_reader->setMemoryMappedReplay(enable); });
+}
+
+void scpUsbReadController::setLoopReplay(bool enable) {
+    onReaderThread([this, enable]() { m_reader->setLoopReplay(enable); });
+}
+
+void scpUsbReadController::setIoUring(bool enable) {
+    onReaderThread([this, enable]() { m_reader->setIoUring(enable); });
+}
+
+void scpUsbReadController::setFraming(bool enable) {
+    onReaderThread([this, enable]() { m_reader->setFraming(enable); });
+}
+
+bool scpUsbReadController::framing() const {
+    return m_reader->framing();
+}
+
+qint64 scpUsbReadController::framesLost() const {
+    return m_reader->framesLost();
+}
+
+void scpUsbReadController::setBatchSize(int bytes) {
+    if (bytes < 0) {
+        handleError("Batch size must not be negative");
+        return;
+    }
+    m_batchBytes = bytes;
+    updateStatus(bytes > 0 ? QString("Batched delivery: %1 bytes or %2 ms").arg(bytes).arg(m_batchIntervalMs)
+                           : QString("Batched delivery off"));
+}
+
+void scpUsbReadController::setBatchInterval(int ms) {
+    if (ms <= 0) {
+        handleError("Batch interval must be positive");
+        return;
+    }
+    m_batchIntervalMs = ms;
+    if (m_batchTimer->isActive()) m_batchTimer->start(ms);
+}
+
+void scpUsbReadController::setBatchAlignment(int bytes) {
+    m_batchAlign = std::max(1, bytes);
+}
+
+void scpUsbReadController::connectReader() {
+    disconnect(m_reader, &scpFTDIReader::dataReceived, this, nullptr);
+    disconnect(m_reader, &scpFTDIReader::readCompleted, this, nullptr);
+    m_batchConnected = m_batchBytes > 0;
+
+    if (!m_batchConnected) {
+        // One queued readForwarded() per read, forwarded as is with the time it completed
+        connect(m_reader, &scpFTDIReader::dataReceived,
+                this, &scpUsbReadController::forwardRead, Qt::DirectConnection);
+        connect(m_reader, &scpFTDIReader::readCompleted,
+                this, &scpUsbReadController::onReaderReadCompleted);
+        return;
+    }
+
+    // Direct connections run on the reader's thread, so a read costs an append
+    // under a short lock instead of a posted event
+    connect(m_reader, &scpFTDIReader::dataReceived, this,
+            [this](const QByteArray& data) { appendBatch(data); }, Qt::DirectConnection);
+    connect(m_reader, &scpFTDIReader::readCompleted, this,
+            [this](int bytesRead) { countBatchRead(bytesRead); }, Qt::DirectConnection);
+}
+
+void scpUsbReadController::appendBatch(const QByteArray& data) {
+    if (data.isEmpty()) return;
+    const qint64 limit = static_cast<qint64>(m_batchBytes) * kMaxBufferedBatches;
+    bool full = false;
+    {
+        QMutexLocker lock(&m_batchMutex);
+        if (m_batchBuffer.size() + data.size() > limit) {
+            // The consumer is not keeping up; refuse rather than grow without bound
+            m_batchOverflowBytes.fetch_add(data.size(), std::memory_order_relaxed);
+            return;
+        }
+        if (m_batchBuffer.capacity() < m_batchBytes + data.size()) {
+            m_batchBuffer.reserve(m_batchBytes + data.size());
+        }
+        m_batchBuffer.append(data);
+        m_batchNewestReadNs = scpMonotonicNs();
+        full = m_batchBuffer.size() >= m_batchBytes;
+    }
+    if (full) scheduleFlush();
+}
+
+void scpUsbReadController::countBatchRead(int bytesRead) {
+    m_readsBatched.fetch_add(1, std::memory_order_relaxed);
+    QMutexLocker lock(&m_batchMutex);
+    m_batchReadBytes += bytesRead;
+}
+
+void scpUsbReadController::scheduleFlush() {
+    // At most one flush in flight however many reads fill the buffer meanwhile
+    if (m_flushScheduled.exchange(true, std::memory_order_acq_rel)) return;
+    QMetaObject::invokeMethod(this, &scpUsbReadController::flushBatch, Qt::QueuedConnection);
+}
+
+void scpUsbReadController::flushBatch() {
+    m_flushScheduled.store(false, std::memory_order_release);
+
+    QByteArray block;
+    qint64 readBytes = 0;
+    qint64 readNs = 0;
+    {
+        QMutexLocker lock(&m_batchMutex);
+        readBytes = m_batchReadBytes;
+        readNs = m_batchNewestReadNs;
+        m_batchReadBytes = 0;
+        const int deliver = m_batchBuffer.size() - m_batchBuffer.size() % m_batchAlign;
+        if (deliver > 0) {
+            // Copy out and keep the reassembly buffer's allocation; an incomplete
+            // unit stays at its front for the next block
+            block = QByteArray(m_batchBuffer.constData(), deliver);
+            m_batchBuffer.remove(0, deliver);
+        }
+    }
+
+    if (readBytes > 0) {
+        if (m_monitor) m_monitor->recordBytesRead(static_cast<int>(readBytes));
+        emit readCompleted(static_cast<int>(readBytes));
+    }
+    if (!block.isEmpty()) {
+        m_batchesDelivered++;
+        m_totalBytesRead += block.size();
+        m_deliveredReadNs = readNs;
+        emit dataReceived(block);
+    }
+}
+
+void scpUsbReadController::finishBatching() {
+    m_batchTimer->stop();
+    if (!m_batchConnected) return;
+    // The reader is stopped: hand over whatever is left, aligned or not
+    const int align = m_batchAlign;
+    m_batchAlign = 1;
+    flushBatch();
+    m_batchAlign = align;
+}
+
 bool scpUsbReadController::isOpen() const {
     return m_reader && m_reader->isOpen();
 }
@@ -61,7 +280,7 @@ bool scpUsbReadController::isRunning() const {
 }
 
 bool scpUsbReadController::open() {
-    if (m_reader->open()) {
+    if (onReaderThread([this]() { return m_reader->open(); })) {
         m_isConnected = true;
         m_errorCount = 0;  // Reset error count on successful open
         emit connected();
@@ -76,9 +295,12 @@ bool scpUsbReadController::open() {
 void scpUsbReadController::close() {
     m_reconnectTimer->stop();
     if (m_reader) {
-        m_reader->stop();
-        m_reader->close();
+        onReaderThread([this]() {
+            m_reader->stop();
+            m_reader->close();
+        });
     }
+    finishBatching();
     if (m_isConnected) {
         m_isConnected = false;
         emit disconnected();
@@ -87,43 +309,70 @@ void scpUsbReadController::close() {
 }
 
 void scpUsbReadController::start() {
+    if (m_batchConnected != (m_batchBytes > 0) && !m_reader->isRunning()) {
+        connectReader();
+    }
+    if (m_batchConnected) {
+        m_batchTimer->start(m_batchIntervalMs);
+    }
+
     if (!m_reader->isOpen()) {
         if (!open()) {
             if (m_autoReconnect) {
                 attemptReconnect();
+            } else {
+                m_batchTimer->stop();
             }
             return;
         }
     }
 
-    m_reader->start();
+    onReaderThread([this]() { m_reader->start(); });
     updateStatus("USB read controller started");
 }
 
 void scpUsbReadController::stop() {
     m_reconnectTimer->stop();
     if (m_reader) {
-        m_reader->stop();
+        onReaderThread([this]() { m_reader->stop(); });
     }
+    finishBatching();
     updateStatus("USB read controller stopped");
 }
 
-void scpUsbReadController::onReaderDataReceived(const QByteArray& data) {
+// Runs on the reader's thread. The reservation keeps the read counted as in flight,
+// and a replay slice or io_uring buffer valid, until deliverRead() is done with it.
+void scpUsbReadController::forwardRead(const QByteArray& data) {
+    const qint64 readNs = scpMonotonicNs();
+    emit readForwarded(data, readNs, m_reader->reserveDelivery(data.size()));
+}
+
+void scpUsbReadController::deliverRead(const QByteArray& data, qint64 readNs,
+                                       const std::shared_ptr<void>& keep) {
+    Q_UNUSED(keep);
     m_totalBytesRead += data.size();
+    m_deliveredReadNs = readNs;
     emit dataReceived(data);
+    m_reader->releaseDelivery(data.size());
 }
 
 void scpUsbReadController::onReaderReadCompleted(int bytesRead) {
+    if (m_monitor) m_monitor->recordBytesRead(bytesRead);
     emit readCompleted(bytesRead);
 }
 
+void scpUsbReadController::onReaderFramesLost(int count) {
+    if (m_monitor) m_monitor->recordFramesLost(count);
+    emit framesLost(count);
+}
+
 void scpUsbReadController::onReaderError(const QString& error) {
     m_errorCount++;
     handleError(error);
     
     // Auto-reconnect on error if enabled
     if (m_autoReconnect && m_reader->isRunning()) {
-        m_reader->stop();
+        onReaderThread([this]() { m_reader->stop(); });
         m_isConnected = false;
         emit disconnected();
         attemptReconnect();
@@ -145,7 +394,7 @@ void scpUsbReadController::attemptReconnect() {
         
         // Restart if we were running before
         if (m_reader) {
-            m_reader->start();
+            onReaderThread([this]() { m_reader->start(); });
         }
     } else {
         // Schedule another reconnect attempt
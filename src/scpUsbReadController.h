@@ -2,7 +2,14 @@
 #include <QObject>
 #include <QTimer>
 #include <QQueue>
+#include <QMutex>
+#include <QThread>
+#include <atomic>
+#include <type_traits>
 #include "scpFTDIInterface.h"
+#include "scpIoThread.h"
+
+class scpThroughputMonitor;
 
 /**
  * @brief High-level controller for USB read operations
@@ -12,6 +19,25 @@
  * - Buffer management
  * - Error recovery
  * - Connection state monitoring
+ * - Optional batched delivery
+ *
+ * By default every read is re-emitted as its own dataReceived/readCompleted
+ * pair. With a batch size set, reads are appended on the reader's thread to
+ * one contiguous reassembly buffer instead, and the controller emits a single
+ * dataReceived/readCompleted pair once the buffer reaches the batch size or
+ * the batch interval elapses. With an alignment set, each delivered block is
+ * a whole multiple of it (e.g. a sample frame); the remainder is carried into
+ * the next block so consumers never see a unit split across two signals.
+ *
+ * startIoThread() moves the reader and its timer onto a dedicated thread
+ * (optionally pinned to a CPU and at realtime priority), so GUI work on
+ * the controller's thread no longer delays reads. Configuration setters
+ * and operations are then carried out on the I/O thread and may be called
+ * from any thread; data still arrives on the controller's thread. Unbatched
+ * memory-mapped and io_uring blocks are views of the mapping or of a read
+ * buffer, valid and counted against the reader's in-flight budget until the
+ * dataReceived() handlers on the controller's thread return; receivers that
+ * queue them elsewhere must copy.
  */
 class scpUsbReadController : public QObject {
     Q_OBJECT
@@ -30,6 +56,35 @@ public:
     void setBytesPerRead(int bytes);
     int bytesPerRead() const;
 
+    // Reader mode and replay options (see scpFTDIReader)
+    void setReadMode(scpFTDIReader::ReadMode mode);
+    scpFTDIReader::ReadMode readMode() const;
+    void setTargetThroughput(double bytesPerSec);
+    double targetThroughput() const;
+    void setMemoryMappedReplay(bool enable);
+    void setLoopReplay(bool enable);
+    void setIoUring(bool enable);
+    void setFraming(bool enable);
+    bool framing() const;
+
+    // Batched delivery (takes effect on start()); batch size 0 = one signal per read
+    void setBatchSize(int bytes);
+    int batchSize() const { return m_batchBytes; }
+    void setBatchInterval(int ms);
+    int batchInterval() const { return m_batchIntervalMs; }
+    void setBatchAlignment(int bytes);
+    int batchAlignment() const { return m_batchAlign; }
+    bool batching() const { return m_batchBytes > 0; }
+
+    // Optional monitor that receives byte counts and lost frames
+    void setThroughputMonitor(scpThroughputMonitor* monitor) { m_monitor = monitor; }
+    scpThroughputMonitor* throughputMonitor() const { return m_monitor; }
+
+    // Dedicated I/O thread for the reader; the tuning also applies to the ThreadedMode thread
+    void startIoThread(const scpThreadTuning& tuning = scpThreadTuning());
+    void stopIoThread();
+    bool hasIoThread() const { return m_ioThread != nullptr; }
+
     // Auto-reconnect settings
     void setAutoReconnect(bool enable) { m_autoReconnect = enable; }
     bool autoReconnect() const { return m_autoReconnect; }
@@ -50,35 +105,84 @@ public:
     qint64 totalBytesRead() const { return m_totalBytesRead; }
     int errorCount() const { return m_errorCount; }
     int reconnectCount() const { return m_reconnectCount; }
+    qint64 framesLost() const;
+    qint64 batchesDelivered() const { return m_batchesDelivered; }
+    qint64 readsBatched() const { return m_readsBatched.load(std::memory_order_relaxed); }
+    // When the newest read in the block being emitted by dataReceived() completed
+    // (scpMonotonicNs()); only meaningful inside slots connected to dataReceived()
+    qint64 deliveredReadNs() const { return m_deliveredReadNs; }
+    qint64 batchOverflowBytes() const { return m_batchOverflowBytes.load(std::memory_order_relaxed); }
 
 signals:
     void dataReceived(const QByteArray& data);
     void readCompleted(int bytesRead);
+    void framesLost(int count);
     void errorOccurred(const QString& error);
     void statusChanged(const QString& status);
     void connected();
     void disconnected();
     void reconnected();
+    // Internal: carries an unbatched read from the reader's thread to ours
+    void readForwarded(const QByteArray& data, qint64 readNs, std::shared_ptr<void> keep);
 
 private slots:
-    void onReaderDataReceived(const QByteArray& data);
     void onReaderReadCompleted(int bytesRead);
+    void onReaderFramesLost(int count);
     void onReaderError(const QString& error);
     void onReaderStatusChanged(const QString& status);
     void attemptReconnect();
+    void flushBatch();
 
 private:
     void updateStatus(const QString& status);
     void handleError(const QString& error);
+    void connectReader();
+    void forwardRead(const QByteArray& data);
+    void deliverRead(const QByteArray& data, qint64 readNs, const std::shared_ptr<void>& keep);
+    void appendBatch(const QByteArray& data);
+    void countBatchRead(int bytesRead);
+    void scheduleFlush();
+    void finishBatching();
+
+    // Runs f on the reader's thread: inline when already there, else blocking
+    template <typename F>
+    auto onReaderThread(F f) -> decltype(f()) {
+        if (!m_ioThread || QThread::currentThread() == m_reader->thread()) return f();
+        if constexpr (std::is_void_v<decltype(f())>) {
+            QMetaObject::invokeMethod(m_reader, f, Qt::BlockingQueuedConnection);
+        } else {
+            decltype(f()) result{};
+            QMetaObject::invokeMethod(m_reader, f, Qt::BlockingQueuedConnection, &result);
+            return result;
+        }
+    }
 
     scpFTDIReader* m_reader;
+    scpIoThread* m_ioThread;
     QString m_devicePath;
     bool m_autoReconnect;
     int m_reconnectDelayMs;
     QTimer* m_reconnectTimer;
+    scpThroughputMonitor* m_monitor;
+
+    // Batched delivery: filled on the reader's thread, drained on ours
+    int m_batchBytes;
+    int m_batchIntervalMs;
+    int m_batchAlign;
+    bool m_batchConnected;
+    QTimer* m_batchTimer;
+    QMutex m_batchMutex;
+    QByteArray m_batchBuffer;       // Contiguous reassembly buffer
+    qint64 m_batchReadBytes;        // Raw bytes read since the last delivery
+    qint64 m_batchNewestReadNs;     // Completion time of the newest read in the buffer
+    std::atomic<bool> m_flushScheduled;
+    std::atomic<qint64> m_readsBatched;
+    std::atomic<qint64> m_batchOverflowBytes;
+    qint64 m_batchesDelivered;
     
     // Statistics
     qint64 m_totalBytesRead;
+    qint64 m_deliveredReadNs;
     int m_errorCount;
     int m_reconnectCount;
     bool m_isConnected;
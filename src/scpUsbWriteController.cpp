@@ -1,25 +1,44 @@
 #include "scpUsbWriteController.h"
 #include "scpFTDIInterface.h"
+#include "scpThroughputMonitor.h"
 #include <QDebug>
-#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+
+// Default byte budget of the controller queue
+static constexpr qint64 kDefaultMaxQueueBytes = 4 * 1024 * 1024;
+// Writes' worth of data kept queued in the writer; the rest waits in the lanes
+static constexpr int kWriterBacklogWrites = 4;
+// A paced writer reports back about once per millisecond; keep this much queued in it
+static constexpr double kPacedBacklogSec = 0.02;
 
 scpUsbWriteController::scpUsbWriteController(QObject* parent)
     : QObject(parent)
     , m_writer(new scpFTDIWriter(this))
-    , m_maxQueueSize(1000)  // Default: 1000 packets
-    , m_flowControlEnabled(true)
+    , m_ioThread(nullptr)
+    , m_queue(kDefaultMaxQueueBytes)
+    , m_coalesceSize(0)
+    , m_drainScheduled(false)
+    , m_clearRequested(false)
     , m_autoReconnect(true)
     , m_reconnectDelayMs(1000)
     , m_reconnectTimer(new QTimer(this))
     , m_totalBytesWritten(0)
     , m_errorCount(0)
     , m_reconnectCount(0)
-    , m_droppedPackets(0)
     , m_isConnected(false)
+    , m_monitor(nullptr)
 {
     m_reconnectTimer->setSingleShot(true);
     connect(m_reconnectTimer, &QTimer::timeout, this, &scpUsbWriteController::attemptReconnect);
 
+    // Refill the writer from its own thread (or its pacing thread): these only post a
+    // drain, so they neither wait for the controller's thread nor re-enter the writer
+    auto refill = [this]() { scheduleProcessQueue(); };
+    connect(m_writer, &scpFTDIWriter::dataWritten, this, refill, Qt::DirectConnection);
+    connect(m_writer, &scpFTDIWriter::writeCompleted, this, refill, Qt::DirectConnection);
+    connect(m_writer, &scpFTDIWriter::queueEmpty, this, refill, Qt::DirectConnection);
+
     // Forward signals from writer
     connect(m_writer, &scpFTDIWriter::dataWritten,
             this, &scpUsbWriteController::onWriterDataWritten);
@@ -35,15 +54,49 @@ scpUsbWriteController::scpUsbWriteController(QObject* parent)
 
 scpUsbWriteController::~scpUsbWriteController() {
     close();
+    stopIoThread();
+}
+
+void scpUsbWriteController::startIoThread(const scpThreadTuning& tuning) {
+    if (m_ioThread) {
+        handleError("I/O thread already running");
+        return;
+    }
+    if (m_writer->isRunning()) {
+        handleError("Cannot move a running writer to an I/O thread");
+        return;
+    }
+
+    // The writer and its timer leave this thread; its signals become queued
+    m_writer->setThreadTuning(tuning);
+    m_ioThread = new scpIoThread("USB write", tuning, this);
+    connect(m_ioThread, &scpIoThread::statusChanged, this, &scpUsbWriteController::updateStatus);
+    m_writer->setParent(nullptr);
+    m_writer->moveToThread(m_ioThread);
+    m_ioThread->start(QThread::HighPriority);
+    updateStatus(QString("I/O thread started (%1)").arg(tuning.toString()));
+}
+
+void scpUsbWriteController::stopIoThread() {
+    if (!m_ioThread) return;
+    // Only the writer's own thread may hand it back
+    QThread* home = thread();
+    onWriterThread([this, home]() { m_writer->moveToThread(home); });
+    m_ioThread->quit();
+    m_ioThread->wait();
+    delete m_ioThread;
+    m_ioThread = nullptr;
+    m_writer->setParent(this);
+    updateStatus("I/O thread stopped");
 }
 
 void scpUsbWriteController::setDevicePath(const QString& path) {
     m_devicePath = path;
-    m_writer->setDevicePath(path);
+    onWriterThread([this, path]() { m_writer->setDevicePath(path); });
 }
 
 void scpUsbWriteController::setOutputFrequency(double frequencyHz) {
-    m_writer->setOutputFrequency(frequencyHz);
+    onWriterThread([this, frequencyHz]() { m_writer->setOutputFrequency(frequencyHz); });
 }
 
 double scpUsbWriteController::outputFrequency() const {
@@ -51,16 +104,43 @@ double scpUsbWriteController::outputFrequency() const {
 }
 
 void scpUsbWriteController::setBytesPerWrite(int bytes) {
-    m_writer->setBytesPerWrite(bytes);
+    onWriterThread([this, bytes]() { m_writer->setBytesPerWrite(bytes); });
 }
 
 int scpUsbWriteController::bytesPerWrite() const {
     return m_writer->bytesPerWrite();
 }
 
-int scpUsbWriteController::queueSize() const {
-    QMutexLocker lock(&m_queueMutex);
-    return m_writeQueue.size();
+void scpUsbWriteController::setWriteMode(scpFTDIWriter::WriteMode mode) {
+    onWriterThread([this, mode]() { m_writer->setWriteMode(mode); });
+}
+
+scpFTDIWriter::WriteMode scpUsbWriteController::writeMode() const {
+    return m_writer->writeMode();
+}
+
+void scpUsbWriteController::setTargetRate(double bytesPerSec) {
+    onWriterThread([this, bytesPerSec]() { m_writer->setTargetRate(bytesPerSec); });
+}
+
+double scpUsbWriteController::targetRate() const {
+    return m_writer->targetRate();
+}
+
+scpFTDIWriter::PacingStats scpUsbWriteController::pacingStats() const {
+    return m_writer->pacingStats();
+}
+
+void scpUsbWriteController::setFraming(bool enable) {
+    onWriterThread([this, enable]() { m_writer->setFraming(enable); });
+}
+
+bool scpUsbWriteController::framing() const {
+    return m_writer->framing();
+}
+
+void scpUsbWriteController::setFramePayloadSize(int bytes) {
+    onWriterThread([this, bytes]() { m_writer->setFramePayloadSize(bytes); });
 }
 
 bool scpUsbWriteController::isOpen() const {
@@ -72,7 +152,7 @@ bool scpUsbWriteController::isRunning() const {
 }
 
 bool scpUsbWriteController::open() {
-    if (m_writer->open()) {
+    if (onWriterThread([this]() { return m_writer->open(); })) {
         m_isConnected = true;
         m_errorCount = 0;  // Reset error count on successful open
         emit connected();
@@ -88,8 +168,10 @@ void scpUsbWriteController::close() {
     m_reconnectTimer->stop();
     clearQueue();
     if (m_writer) {
-        m_writer->stop();
-        m_writer->close();
+        onWriterThread([this]() {
+            m_writer->stop();
+            m_writer->close();
+        });
     }
     if (m_isConnected) {
         m_isConnected = false;
@@ -108,10 +190,10 @@ void scpUsbWriteController::start() {
         }
     }
 
-    m_writer->start();
+    onWriterThread([this]() { m_writer->start(); });
     
     // Process any queued data
-    processQueue();
+    requestProcessQueue();
     
     updateStatus("USB write controller started");
 }
@@ -119,59 +201,73 @@ void scpUsbWriteController::start() {
 void scpUsbWriteController::stop() {
     m_reconnectTimer->stop();
     if (m_writer) {
-        m_writer->stop();
+        onWriterThread([this]() { m_writer->stop(); });
     }
     updateStatus("USB write controller stopped");
 }
 
-bool scpUsbWriteController::queueData(const QByteArray& data) {
-    QMutexLocker lock(&m_queueMutex);
-    
-    // Check queue size
-    if (m_writeQueue.size() >= m_maxQueueSize) {
-        if (m_flowControlEnabled) {
-            // Drop oldest packet
-            m_writeQueue.dequeue();
-            m_droppedPackets++;
-            emit queueFull();
-        } else {
-            // Reject new data
-            return false;
-        }
+bool scpUsbWriteController::queueData(const QByteArray& data, scpWriteQueue::Lane lane) {
+    if (!m_queue.push(data, lane)) {
+        // Over the byte budget (or flow control off): counted as dropped by the queue
+        emit queueFull();
+        return false;
     }
-    
-    m_writeQueue.enqueue(data);
-    
-    // If writer is running, try to send immediately
-    if (m_writer && m_writer->isRunning() && m_writer->isOpen()) {
-        lock.unlock();
+
+    requestProcessQueue();
+    return true;
+}
+
+void scpUsbWriteController::requestProcessQueue() {
+    if (QThread::currentThread() == m_writer->thread()) {
         processQueue();
+    } else {
+        scheduleProcessQueue();
     }
-    
-    return true;
+}
+
+void scpUsbWriteController::scheduleProcessQueue() {
+    // One pending drain is enough however many producers pushed meanwhile
+    if (m_drainScheduled.exchange(true, std::memory_order_acq_rel)) return;
+    QMetaObject::invokeMethod(m_writer, [this]() {
+        m_drainScheduled.store(false, std::memory_order_release);
+        processQueue();
+    }, Qt::QueuedConnection);
 }
 
 void scpUsbWriteController::clearQueue() {
-    QMutexLocker lock(&m_queueMutex);
-    m_writeQueue.clear();
+    // clear() is a consumer operation: leave it to the drain
+    m_clearRequested.store(true, std::memory_order_release);
+    requestProcessQueue();
 }
 
 bool scpUsbWriteController::processQueue() {
+    if (m_clearRequested.exchange(false, std::memory_order_acq_rel)) {
+        m_queue.clear();
+    }
+
+    // Drop-oldest happens here, on the consumer side of the queue
+    if (m_queue.trimToBudget() > 0) {
+        emit queueFull();
+    }
+
     if (!m_writer || !m_writer->isOpen() || !m_writer->isRunning()) {
         return false;
     }
 
-    QMutexLocker lock(&m_queueMutex);
-    
-    // Send data from queue to writer
-    while (!m_writeQueue.isEmpty() && m_writer->queuedDataSize() < m_maxQueueSize / 2) {
-        QByteArray data = m_writeQueue.dequeue();
+    // Keep only a few writes' worth in the writer so control packets can still overtake bulk
+    const int bytesPerWrite = m_writer->bytesPerWrite();
+    const int chunk = m_coalesceSize > 0 ? m_coalesceSize : bytesPerWrite;
+    qint64 backlog = static_cast<qint64>(kWriterBacklogWrites) * std::max(bytesPerWrite, chunk);
+    if (m_writer->writeMode() == scpFTDIWriter::PacedMode) {
+        backlog = std::max(backlog, static_cast<qint64>(m_writer->effectiveRate() * kPacedBacklogSec));
+    }
+    QByteArray data;
+    while (m_writer->queuedDataSize() < backlog && m_queue.popCoalesced(chunk, data)) {
         m_writer->queueData(data);
     }
 
     // Check if queue is empty
-    if (m_writeQueue.isEmpty()) {
-        lock.unlock();
+    if (m_queue.queuedPackets() == 0) {
         emit queueEmpty();
     }
 
@@ -180,20 +276,16 @@ bool scpUsbWriteController::processQueue() {
 
 void scpUsbWriteController::onWriterDataWritten(int bytesWritten) {
     m_totalBytesWritten += bytesWritten;
+    if (m_monitor) m_monitor->recordBytesWritten(bytesWritten);
     emit dataWritten(bytesWritten);
-    
-    // Process more from queue
-    processQueue();
 }
 
 void scpUsbWriteController::onWriterWriteCompleted() {
     emit writeCompleted();
-    processQueue();
 }
 
 void scpUsbWriteController::onWriterQueueEmpty() {
     emit queueEmpty();
-    processQueue();
 }
 
 void scpUsbWriteController::onWriterError(const QString& error) {
@@ -202,7 +294,7 @@ void scpUsbWriteController::onWriterError(const QString& error) {
     
     // Auto-reconnect on error if enabled
     if (m_autoReconnect && m_writer->isRunning()) {
-        m_writer->stop();
+        onWriterThread([this]() { m_writer->stop(); });
         m_isConnected = false;
         emit disconnected();
         attemptReconnect();
@@ -224,8 +316,8 @@ void scpUsbWriteController::attemptReconnect() {
         
         // Restart if we were running before
         if (m_writer) {
-            m_writer->start();
-            processQueue();
+            onWriterThread([this]() { m_writer->start(); });
+            requestProcessQueue();
         }
     } else {
         // Schedule another reconnect attempt
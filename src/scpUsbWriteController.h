@@ -1,9 +1,14 @@
 #pragma once
 #include <QObject>
 #include <QTimer>
-#include <QQueue>
-#include <QMutex>
+#include <QThread>
+#include <atomic>
+#include <type_traits>
 #include "scpFTDIInterface.h"
+#include "scpIoThread.h"
+#include "scpWriteQueue.h"
+
+class scpThroughputMonitor;
 
 /**
  * @brief High-level controller for USB write operations
@@ -13,6 +18,21 @@
  * - Auto-reconnect on errors
  * - Buffer overflow protection
  * - Write statistics
+ *
+ * Pending data sits in a lock-free scpWriteQueue bounded by bytes, so any
+ * thread can queue without taking a lock. Control packets overtake bulk
+ * data, and small bulk packets are merged into transfer-sized chunks
+ * before they reach the writer.
+ *
+ * startIoThread() moves the writer and its timer onto a dedicated thread
+ * (optionally pinned to a CPU and at realtime priority), so GUI work on
+ * the controller's thread no longer delays writes. Configuration setters
+ * and operations are then carried out on the I/O thread and may be called
+ * from any thread; the queue itself is already thread-safe.
+ *
+ * The queue is drained on the writer's thread, woken by the writer's own
+ * progress signals, so a stalled controller thread cannot starve the writer.
+ * queueFull() and queueEmpty() are emitted from that thread.
  */
 class scpUsbWriteController : public QObject {
     Q_OBJECT
@@ -31,10 +51,36 @@ public:
     void setBytesPerWrite(int bytes);
     int bytesPerWrite() const;
 
-    // Queue management
-    void setMaxQueueSize(int maxSize) { m_maxQueueSize = maxSize; }
-    int maxQueueSize() const { return m_maxQueueSize; }
-    int queueSize() const;
+    // Writer pacing (see scpFTDIWriter::PacedMode)
+    void setWriteMode(scpFTDIWriter::WriteMode mode);
+    scpFTDIWriter::WriteMode writeMode() const;
+    void setTargetRate(double bytesPerSec);
+    double targetRate() const;
+    scpFTDIWriter::PacingStats pacingStats() const;
+
+    // Framing of queued data (see scpFTDIWriter)
+    void setFraming(bool enable);
+    bool framing() const;
+    void setFramePayloadSize(int bytes);
+
+    // Queue management (limit in bytes across both lanes)
+    void setMaxQueueBytes(qint64 bytes) { m_queue.setByteBudget(bytes); }
+    qint64 maxQueueBytes() const { return m_queue.byteBudget(); }
+    int queueSize() const { return m_queue.queuedPackets(); }
+    qint64 queuedBytes() const { return m_queue.queuedBytes(); }
+
+    // Bulk packets smaller than this are merged before writing; 0 = bytes per write
+    void setCoalesceSize(int bytes) { m_coalesceSize = bytes; }
+    int coalesceSize() const { return m_coalesceSize; }
+
+    // Dedicated I/O thread for the writer; the tuning also applies to the PacedMode thread
+    void startIoThread(const scpThreadTuning& tuning = scpThreadTuning());
+    void stopIoThread();
+    bool hasIoThread() const { return m_ioThread != nullptr; }
+
+    // Optional monitor fed with the bytes written (not owned)
+    void setThroughputMonitor(scpThroughputMonitor* monitor) { m_monitor = monitor; }
+    scpThroughputMonitor* throughputMonitor() const { return m_monitor; }
 
     // Auto-reconnect settings
     void setAutoReconnect(bool enable) { m_autoReconnect = enable; }
@@ -42,9 +88,9 @@ public:
     void setReconnectDelay(int ms) { m_reconnectDelayMs = ms; }
     int reconnectDelay() const { return m_reconnectDelayMs; }
 
-    // Flow control
-    void setFlowControlEnabled(bool enable) { m_flowControlEnabled = enable; }
-    bool flowControlEnabled() const { return m_flowControlEnabled; }
+    // Flow control: drop the oldest bulk data when full (otherwise reject new data)
+    void setFlowControlEnabled(bool enable) { m_queue.setDropOldest(enable); }
+    bool flowControlEnabled() const { return m_queue.dropOldest(); }
 
     // State
     bool isOpen() const;
@@ -56,15 +102,19 @@ public:
     void start();
     void stop();
 
-    // Queue data for writing (thread-safe)
-    bool queueData(const QByteArray& data);
+    // Queue data for writing (thread-safe, lock-free); false if it was dropped
+    bool queueData(const QByteArray& data, scpWriteQueue::Lane lane = scpWriteQueue::BulkLane);
+    bool queueControl(const QByteArray& data) { return queueData(data, scpWriteQueue::ControlLane); }
+    // Discards everything queued so far; carried out by the drain on the writer's thread
     void clearQueue();
 
     // Statistics
     qint64 totalBytesWritten() const { return m_totalBytesWritten; }
     int errorCount() const { return m_errorCount; }
     int reconnectCount() const { return m_reconnectCount; }
-    int droppedPackets() const { return m_droppedPackets; }
+    qint64 droppedPackets() const { return m_queue.droppedPackets(); }
+    qint64 droppedBytes() const { return m_queue.droppedBytes(); }
+    qint64 coalescedPackets() const { return m_queue.coalescedPackets(); }
 
 signals:
     void dataWritten(int bytesWritten);
@@ -88,16 +138,34 @@ private slots:
 private:
     void updateStatus(const QString& status);
     void handleError(const QString& error);
+    // The drain: the only consumer of m_queue, run on the writer's thread
     bool processQueue();
+    // Runs processQueue() inline when on the writer's thread, else posts it there
+    void requestProcessQueue();
+    void scheduleProcessQueue();
+
+    // Runs f on the writer's thread: inline when already there, else blocking
+    template <typename F>
+    auto onWriterThread(F f) -> decltype(f()) {
+        if (!m_ioThread || QThread::currentThread() == m_writer->thread()) return f();
+        if constexpr (std::is_void_v<decltype(f())>) {
+            QMetaObject::invokeMethod(m_writer, f, Qt::BlockingQueuedConnection);
+        } else {
+            decltype(f()) result{};
+            QMetaObject::invokeMethod(m_writer, f, Qt::BlockingQueuedConnection, &result);
+            return result;
+        }
+    }
 
     scpFTDIWriter* m_writer;
+    scpIoThread* m_ioThread;
     QString m_devicePath;
     
     // Queue management
-    QQueue<QByteArray> m_writeQueue;
-    mutable QMutex m_queueMutex;
-    int m_maxQueueSize;
-    bool m_flowControlEnabled;
+    scpWriteQueue m_queue;
+    int m_coalesceSize;
+    std::atomic<bool> m_drainScheduled;
+    std::atomic<bool> m_clearRequested;
     
     // Auto-reconnect
     bool m_autoReconnect;
@@ -108,7 +176,7 @@ private:
     qint64 m_totalBytesWritten;
     int m_errorCount;
     int m_reconnectCount;
-    int m_droppedPackets;
     bool m_isConnected;
+    scpThroughputMonitor* m_monitor;
 };
 
@@ -1,6 +1,8 @@
 #include "scpViewTerminal.h"
 #include "scpTerminalController.h"
 #include "scpDataSource.h"
+#include "scpThroughputMonitor.h"
+#include "scpTrace.h"
 #include "scpSignalGeneratorSource.h"
 #include "scpSimulatedGeneratorSource.h"
 #include "scpSimulatedAcquisitionSource.h"
@@ -9,22 +11,76 @@
 #include <QDebug>
 #include <QTimer>
 #include <QThread>
+#include <QMutexLocker>
 #ifdef Q_OS_UNIX
 #include <QSocketNotifier>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <sys/select.h>
 #elif defined(Q_OS_WIN)
 #include <windows.h>
 #endif
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+
+// Frame sizes used when the output link cannot keep up (full size first)
+static const struct { int width; int height; } kFrameSizes[] = {
+    {80, 20}, {64, 16}, {48, 12}, {32, 8}
+};
+static constexpr int kFrameSizeCount = sizeof(kFrameSizes) / sizeof(kFrameSizes[0]);
+
+TerminalRenderWorker::TerminalRenderWorker(scpViewTerminal* parent)
+    : m_parent(parent) {
+}
+
+void TerminalRenderWorker::stop() {
+    m_shouldStop = true;
+    {
+        QMutexLocker lock(&m_parent->m_renderMutex);
+        m_parent->m_renderCond.wakeAll();
+    }
+    // A frame build is bounded, so this returns; deleting a running thread would abort
+    wait();
+}
+
+void TerminalRenderWorker::run() {
+    SCP_TRACE_THREAD_NAME("terminal render");
+    // Scratch storage reused across frames so steady-state rendering does not allocate
+    QVector<float> samples[scpViewTerminal::kMaxTraces];
+    std::vector<quint8> grid;
+
+    while (!m_shouldStop) {
+        scpViewTerminal::RenderParams params;
+        {
+            QMutexLocker lock(&m_parent->m_renderMutex);
+            while (!m_parent->m_frameRequested && !m_shouldStop) {
+                m_parent->m_renderCond.wait(&m_parent->m_renderMutex);
+            }
+            if (m_shouldStop) break;
+            params = m_parent->m_pendingParams;
+            m_parent->m_frameRequested = false;
+        }
+
+        // Build into the back buffer without holding the lock; only this thread touches it
+        m_parent->buildFrame(params, samples, grid, m_parent->m_backBuffer, m_parent->m_backSampleNs);
+
+        {
+            QMutexLocker lock(&m_parent->m_renderMutex);
+            m_parent->m_backBuffer.swap(m_parent->m_frontBuffer);
+            std::swap(m_parent->m_backSampleNs, m_parent->m_frontSampleNs);
+            m_parent->m_frameReady = true;
+        }
+        QMetaObject::invokeMethod(m_parent, "onFrameReady", Qt::QueuedConnection);
+    }
+}
 
 scpViewTerminal::scpViewTerminal(QObject* parent)
     : QObject(parent),
       m_out(stdout),
       m_in(stdin) {
-    m_timer.setInterval(200); // ~5 FPS - slower to allow typing without interference
+    m_timer.setInterval(kBaseFrameIntervalMs); // ~5 FPS - slower to allow typing without interference
     QObject::connect(&m_timer, &QTimer::timeout, this, &scpViewTerminal::onTick);
 
     // Initialize controller for command processing
@@ -60,10 +116,18 @@ scpViewTerminal::scpViewTerminal(QObject* parent)
 
     m_useAnsi = !qEnvironmentVariableIsEmpty("TERM");
     printHelp();
+
+    m_renderWorker = new TerminalRenderWorker(this);
+    m_renderWorker->start();
 }
 
 scpViewTerminal::~scpViewTerminal() {
-    // Qt parent-child relationship handles cleanup
+    // Render worker is not a QObject child; stop it before members go away
+    if (m_renderWorker) {
+        m_renderWorker->stop();
+        delete m_renderWorker;
+        m_renderWorker = nullptr;
+    }
 }
 
 void scpViewTerminal::setSource(scpDataSource* src) {
@@ -90,6 +154,13 @@ void scpViewTerminal::setGeneratorSource(scpDataSource* src) {
     }
 }
 
+void scpViewTerminal::setThroughputMonitor(scpThroughputMonitor* monitor) {
+    m_monitor = monitor;
+    if (m_controller) {
+        m_controller->setThroughputMonitor(monitor);
+    }
+}
+
 void scpViewTerminal::start() {
     m_timer.start();
     if (m_source && !m_source->isActive()) m_source->start();
@@ -111,14 +182,17 @@ void scpViewTerminal::onTick() {
                           (m_generatorSource && m_generatorSource->isActive());
     
     if (inCombinedMode) {
-        // In combined mode, display acquisition source (or combine both)
-        const int sr = m_acquisitionSource->sampleRate();
-        const int needed = std::max(100, (int)std::ceil(sr * m_timeWindowSec));
-        QVector<float> s;
-        int got = m_acquisitionSource->copyRecentSamples(needed, s);
-        if (got > 0) {
-            printFrame(s);
+        // In combined mode, overlay stimulus and response (plus the main source if it
+        // is a different active channel) in one grid
+        Trace traces[kMaxTraces];
+        int count = 0;
+        traces[count++] = Trace{m_acquisitionSource, "ACQ", '*', "\x1b[32m"};
+        traces[count++] = Trace{m_generatorSource, "GEN", '+', "\x1b[33m"};
+        if (m_source && m_source->isActive() && m_source->sampleRate() > 0 &&
+            m_source != m_acquisitionSource && m_source != m_generatorSource) {
+            traces[count++] = Trace{m_source, "SRC", 'o', "\x1b[36m"};
         }
+        requestFrame(traces, count);
         return;
     }
     
@@ -136,17 +210,25 @@ void scpViewTerminal::onTick() {
     // Reset the flag when source becomes active
     static bool shown = false;
     shown = false;
-    const int sr = m_source->sampleRate();
-    // Calculate how many samples we need based on time window
-    // m_timeWindowSec is total time for 10 divisions
-    const int needed = std::max(100, (int)std::ceil(sr * m_timeWindowSec));
-    QVector<float> s;
-    int got = m_source->copyRecentSamples(needed, s);
-    if (got > 0) {
-        printFrame(s);
-        // Debug info (optional - can be removed)
-        // The waveform will visibly change - wider window shows more data points
+    const Trace single{m_source, "CH1", '*', ""};
+    requestFrame(&single, 1);
+}
+
+void scpViewTerminal::requestFrame(const Trace* traces, int traceCount) {
+    // Hand the current settings to the render worker; a request that arrives while
+    // a frame is still being built simply replaces the pending one
+    QMutexLocker lock(&m_renderMutex);
+    m_pendingParams.traceCount = std::min(traceCount, (int)kMaxTraces);
+    for (int t = 0; t < m_pendingParams.traceCount; ++t) {
+        m_pendingParams.traces[t] = traces[t];
     }
+    m_pendingParams.timeWindowSec = m_timeWindowSec;
+    m_pendingParams.unitsPerDiv = m_unitsPerDiv;
+    m_pendingParams.useAnsi = m_useAnsi;
+    m_pendingParams.width = kFrameSizes[m_resolutionLevel].width;
+    m_pendingParams.height = kFrameSizes[m_resolutionLevel].height;
+    m_frameRequested = true;
+    m_renderCond.wakeOne();
 }
 
 void scpViewTerminal::printHelp() {
@@ -170,18 +252,38 @@ void scpViewTerminal::printHelp() {
     m_out << Qt::endl;
 }
 
-void scpViewTerminal::printFrame(const QVector<float>& samples) {
-    // Don't update display if user is typing
-    if (m_isTyping) {
-        return;
+void scpViewTerminal::buildFrame(const RenderParams& params, QVector<float>* samples,
+                                 std::vector<quint8>& grid, QByteArray& out, qint64& sampleNs) {
+    // Runs on the render worker: fetch, decimate, fill the grid and assemble the bytes
+    SCP_TRACE_SCOPE("buildFrame");
+    out.clear();
+    sampleNs = 0;
+
+    // Fetch every trace once into worker-owned scratch; decimation reads these directly
+    // Calculate how many samples we need based on time window
+    // timeWindowSec is total time for 10 divisions
+    int steps[kMaxTraces] = {};
+    int counts[kMaxTraces] = {};
+    bool any = false;
+    const int width = params.width;
+    const int height = params.height;
+    for (int t = 0; t < params.traceCount; ++t) {
+        scpDataSource* src = params.traces[t].source;
+        const int sr = src ? src->sampleRate() : 0;
+        if (sr <= 0) continue;
+        const int needed = std::max(100, (int)std::ceil(sr * params.timeWindowSec));
+        const qint64 stamp = src->newestSampleTimeNs();  // Before the copy: data is at least this fresh
+        counts[t] = std::max(0, src->copyRecentSamples(needed, samples[t]));
+        if (counts[t] > 0 && stamp > 0 && (sampleNs == 0 || stamp < sampleNs)) sampleNs = stamp;
+        steps[t] = std::max(1, counts[t] / width);
+        any = any || counts[t] > 0;
     }
-    
-    const int width = 80;
-    const int height = 20;
-    const float unitsPerScreen = m_unitsPerDiv * 8.0f; // 8 divs vertically
+    if (!any) return;
+
+    const float unitsPerScreen = params.unitsPerDiv * 8.0f; // 8 divs vertically
 
-    // Prepare a buffer of spaces
-    std::vector<char> grid(width * height, ' ');
+    // Each cell holds a bitmask of the traces passing through it
+    grid.assign(width * height, 0);
 
     auto toYrow = [&](float v) {
         float normalized = (v / (unitsPerScreen/2.0f)); // -1..1 across half-screen
@@ -190,63 +292,238 @@ void scpViewTerminal::printFrame(const QVector<float>& samples) {
         return row;
     };
 
-    // Center line
-    int mid = height/2;
-    for (int x=0;x<width;++x) grid[mid*width + x] = '-';
-
-    // Decimate to columns by min/max envelope
-    const int N = samples.size();
-    const int step = std::max(1, N / width);
+    // Decimate every trace to columns by min/max envelope in a single pass over the columns
+    const float invUnitsPerDiv = 1.0f / params.unitsPerDiv;
     for (int x=0; x<width; ++x) {
-        int start = x * step;
-        int end = std::min(N, start + step);
-        if (start >= end) break;
-        float vmin =  1e9f, vmax = -1e9f;
-        for (int i = start; i < end; ++i) {
-            float v = samples[i] * (1.0f / m_unitsPerDiv);
-            vmin = std::min(vmin, v);
-            vmax = std::max(vmax, v);
-        }
-        int r1 = toYrow(vmin);
-        int r2 = toYrow(vmax);
-        if (r1 > r2) std::swap(r1, r2);
-        for (int r=r1; r<=r2; ++r) {
-            grid[r*width + x] = '*';
+        for (int t = 0; t < params.traceCount; ++t) {
+            const int N = counts[t];
+            int start = x * steps[t];
+            int end = std::min(N, start + steps[t]);
+            if (start >= end) continue;
+            const float* data = samples[t].constData();
+            float vmin =  1e9f, vmax = -1e9f;
+            for (int i = start; i < end; ++i) {
+                float v = data[i] * invUnitsPerDiv;
+                vmin = std::min(vmin, v);
+                vmax = std::max(vmax, v);
+            }
+            int r1 = toYrow(vmin);
+            int r2 = toYrow(vmax);
+            if (r1 > r2) std::swap(r1, r2);
+            for (int r=r1; r<=r2; ++r) {
+                grid[r*width + x] |= quint8(1u << t);
+            }
         }
     }
 
-    // CRITICAL: Never clear screen if user is typing
-    if (m_isTyping) {
-        return;  // Don't even try to update display
-    }
-    
-    // Only clear/update if not typing
-    if (m_useAnsi) {
+    out.reserve((width + 1) * (height + 5) + 256);
+    if (params.useAnsi) {
         // Move cursor to top-left and clear entire screen first
-        m_out << "\x1b[1;1H";  // Go to row 1, col 1
-        m_out << "\x1b[2J";    // Clear entire screen
-        m_out << "\x1b[1;1H";   // Back to top
+        out.append("\x1b[1;1H");  // Go to row 1, col 1
+        out.append("\x1b[2J");    // Clear entire screen
+        out.append("\x1b[1;1H");  // Back to top
     } else {
-        m_out << Qt::endl << Qt::endl;  // Add some spacing if no ANSI
+        out.append("\n\n");  // Add some spacing if no ANSI
     }
-    
+
     // Print header (keep it short to fit on one line - max 80 chars)
-    double timePerDiv = (m_timeWindowSec / 10.0) * 1000.0;  // Convert to ms
+    double timePerDiv = (params.timeWindowSec / 10.0) * 1000.0;  // Convert to ms
     QString header = QString("Time/div: %1 ms    Units/div: %2    %3")
                      .arg(timePerDiv, 0, 'f', 1)
-                     .arg(m_unitsPerDiv, 0, 'f', 2)
+                     .arg(params.unitsPerDiv, 0, 'f', 2)
                      .arg(QDateTime::currentDateTime().toString("HH:mm:ss"));
-    m_out << header << Qt::endl;
+    out.append(header.toUtf8());
+    out.append('\n');
 
+    // Legend line when several channels share the grid
+    if (params.traceCount > 1) {
+        for (int t = 0; t < params.traceCount; ++t) {
+            const Trace& tr = params.traces[t];
+            if (params.useAnsi) out.append(tr.ansiColor);
+            out.append(tr.glyph);
+            out.append(' ');
+            out.append(tr.label);
+            if (params.useAnsi) out.append("\x1b[0m");
+            out.append("    ");
+        }
+        out.append("# overlap\n");
+    }
+
+    const int mid = height/2;
     for (int r=0; r<height; ++r) {
-        m_out << QString::fromLatin1(grid.data() + r*width, width) << Qt::endl;
+        // Emit colour changes only at run boundaries to keep the byte count down
+        const char* activeColor = "";
+        for (int x = 0; x < width; ++x) {
+            const quint8 mask = grid[r*width + x];
+            char ch;
+            const char* color = "";
+            if (mask == 0) {
+                ch = (r == mid) ? '-' : ' ';  // Center line
+            } else if ((mask & (mask - 1)) == 0) {
+                int t = 0;
+                while (!(mask & (1u << t))) ++t;
+                ch = params.traces[t].glyph;
+                color = params.traces[t].ansiColor;
+            } else {
+                ch = '#';
+            }
+            if (params.useAnsi && qstrcmp(color, activeColor) != 0) {
+                out.append(*color ? color : "\x1b[0m");
+                activeColor = color;
+            }
+            out.append(ch);
+        }
+        if (params.useAnsi && *activeColor) out.append("\x1b[0m");
+        out.append('\n');
     }
-    
-    // Add separator line - but only if not typing (to avoid overwriting commands)
-    if (!m_isTyping) {
-        m_out << "────────────────────────────────────────────────────────────────────────" << Qt::endl;
+
+    // Separator as wide as the grid, so smaller frames stay smaller
+    for (int x = 0; x < width; ++x) out.append("─");
+    out.append('\n');
+}
+
+void scpViewTerminal::onFrameReady() {
+    printFrame();
+}
+
+void scpViewTerminal::printFrame() {
+    SCP_TRACE_SCOPE("printFrame");
+    // CRITICAL: Never touch the screen if user is typing; the frame is simply dropped
+    if (m_isTyping) {
+        return;
+    }
+
+    {
+        QMutexLocker lock(&m_renderMutex);
+        if (!m_frameReady) return;
+        m_frameReady = false;
+        // Swap the finished frame out so the worker can start the next one immediately
+        m_frontBuffer.swap(m_writeBuffer);
+        std::swap(m_frontSampleNs, m_writeSampleNs);
+    }
+
+    if (!m_writeBuffer.isEmpty()) {
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+        const qint64 written = writeFrame(m_writeBuffer);
+        adaptToWriteTime(writeTimer.nsecsElapsed() / 1.0e6, written);
+
+        // Sensor-to-pixel latency, once per block: the first frame written that shows it
+        if (written == m_writeBuffer.size() && m_monitor && m_writeSampleNs > 0 && m_writeSampleNs != m_lastShownSampleNs) {
+            m_monitor->recordLatency(static_cast<int>((scpMonotonicNs() - m_writeSampleNs) / 1000));
+            m_lastShownSampleNs = m_writeSampleNs;
+        }
+    }
+}
+
+#ifdef Q_OS_UNIX
+// Writes to non-blocking stdout until done or budgetUs has passed on clock; returns bytes written
+static qint64 writeStdout(const char* p, qint64 size, const QElapsedTimer& clock, qint64 budgetUs) {
+    qint64 left = size;
+    while (left > 0) {
+        ssize_t n = ::write(STDOUT_FILENO, p, static_cast<size_t>(left));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                const qint64 remainingUs = budgetUs - clock.nsecsElapsed() / 1000;
+                if (remainingUs <= 0) break;
+                fd_set writefds;
+                FD_ZERO(&writefds);
+                FD_SET(STDOUT_FILENO, &writefds);
+                timeval timeout;
+                timeout.tv_sec = static_cast<time_t>(remainingUs / 1000000);
+                timeout.tv_usec = static_cast<suseconds_t>(remainingUs % 1000000);
+                if (select(STDOUT_FILENO + 1, nullptr, &writefds, nullptr, &timeout) == 0) break;
+                continue;
+            }
+            break;  // Output closed or broken; nothing sensible to do
+        }
+        p += n;
+        left -= n;
     }
+    return size - left;
+}
+#endif
+
+qint64 scpViewTerminal::writeFrame(const QByteArray& frame) {
+    // Anything queued on the text stream (command responses) must go out first
     m_out.flush();
+#ifdef Q_OS_UNIX
+    // Wait for the terminal at most one frame interval; a stalled terminal (Ctrl-S,
+    // a stuck pipe) must not freeze the event loop. The rest of the frame is dropped
+    // and the long write makes adaptToWriteTime() back off.
+    QElapsedTimer clock;
+    clock.start();
+    const qint64 budgetUs = m_frameIntervalMs * 1000LL;
+
+    // A cut frame may have stopped inside an SGR escape or a multi-byte glyph: the
+    // ESC ends either, then colours are reset and the cursor homed before drawing
+    static const char kResync[] = "\x1b[0m\x1b[H";
+    if (m_frameCut) {
+        const qint64 resync = static_cast<qint64>(sizeof(kResync) - 1);
+        if (writeStdout(kResync, resync, clock, budgetUs) < resync) return 0;
+        m_frameCut = false;
+    }
+    const qint64 written = writeStdout(frame.constData(), frame.size(), clock, budgetUs);
+    m_frameCut = m_useAnsi && written < frame.size();  // Plain output just scrolls on
+    return written;
+#else
+    const size_t written = fwrite(frame.constData(), 1, static_cast<size_t>(frame.size()), stdout);
+    fflush(stdout);
+    return static_cast<qint64>(written);
+#endif
+}
+
+void scpViewTerminal::setAdaptiveFrameRate(bool enable) {
+    m_adaptive = enable;
+    if (!enable) {
+        m_resolutionLevel = 0;
+        m_frameIntervalMs = kBaseFrameIntervalMs;
+        m_timer.setInterval(m_frameIntervalMs);
+    }
+}
+
+void scpViewTerminal::adaptToWriteTime(double writeMs, qint64 bytes) {
+    // A terminal behind a slow link blocks write() once the pty buffer fills, so the
+    // time spent writing a frame tracks what the link can actually carry
+    if (writeMs > 0.0) {
+        m_outputBytesPerSec = bytes / (writeMs / 1000.0);
+    }
+    m_writeMsAvg = (m_writeMsAvg == 0.0) ? writeMs : 0.7 * m_writeMsAvg + 0.3 * writeMs;
+    if (!m_adaptive) return;
+
+    const double load = m_writeMsAvg / m_frameIntervalMs;
+    int interval = m_frameIntervalMs;
+    if (load > 0.5) {
+        // Writes eat more than half of each frame period: back off the rate first,
+        // then shrink the frame once the rate is already at its floor
+        m_fastFrames = 0;
+        if (interval < kMaxFrameIntervalMs) {
+            interval = std::min(kMaxFrameIntervalMs, interval * 3 / 2);
+        } else if (m_resolutionLevel < kFrameSizeCount - 1) {
+            ++m_resolutionLevel;
+            m_writeMsAvg = 0.0;  // Re-measure at the new size
+        }
+    } else if (load < 0.1) {
+        // Link has plenty of headroom; recover after a run of fast frames,
+        // restoring resolution before frame rate
+        if (++m_fastFrames >= 10) {
+            m_fastFrames = 0;
+            if (m_resolutionLevel > 0) {
+                --m_resolutionLevel;
+                m_writeMsAvg = 0.0;
+            } else if (interval > kBaseFrameIntervalMs) {
+                interval = std::max(kBaseFrameIntervalMs, interval * 2 / 3);
+            }
+        }
+    } else {
+        m_fastFrames = 0;
+    }
+
+    if (interval != m_frameIntervalMs) {
+        m_frameIntervalMs = interval;
+        m_timer.setInterval(m_frameIntervalMs);
+    }
 }
 
 void scpViewTerminal::onStdinActivity() {
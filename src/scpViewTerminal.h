@@ -4,9 +4,16 @@
 #include <QVector>
 #include <QTextStream>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <atomic>
+#include <vector>
 #include "scpView.h"
 
 class scpTerminalController;
+class TerminalRenderWorker;
 
 class scpViewTerminal : public QObject, public scpView {
     Q_OBJECT
@@ -22,6 +29,17 @@ public:
     void start();
     void stop();
 
+    // Adaptive frame rate: slow down and shrink the frame when stdout writes are slow
+    void setAdaptiveFrameRate(bool enable);
+    bool adaptiveFrameRate() const { return m_adaptive; }
+    int frameIntervalMs() const { return m_frameIntervalMs; }
+    double outputBytesPerSecond() const { return m_outputBytesPerSec; }
+    // Smoothed time spent writing one frame to stdout
+    double frameWriteMs() const { return m_writeMsAvg; }
+    // Receives the sensor-to-pixel latency of each block when it is first written out;
+    // the perf command reports from the same monitor
+    void setThroughputMonitor(class scpThroughputMonitor* monitor);
+
 private slots:
     void onTick();
     void onStdinActivity();
@@ -29,9 +47,38 @@ private slots:
     void onControllerStopRequested();
     void onControllerQuitRequested();
     void onControllerViewUpdateNeeded();
+    void onFrameReady();
 
 private:
-    void printFrame(const QVector<float>& samples);
+    friend class TerminalRenderWorker;
+
+    // One channel drawn into the shared grid
+    struct Trace {
+        class scpDataSource* source = nullptr;
+        const char* label = "";
+        char glyph = '*';
+        const char* ansiColor = "";  // SGR sequence used when ANSI output is on
+    };
+    static constexpr int kMaxTraces = 4;
+
+    // Snapshot of everything the render worker needs to build one frame
+    struct RenderParams {
+        Trace traces[kMaxTraces];
+        int traceCount = 0;
+        double timeWindowSec = 0.5;
+        float unitsPerDiv = 1.0f;
+        bool useAnsi = false;
+        int width = 80;
+        int height = 20;
+    };
+
+    void requestFrame(const Trace* traces, int traceCount);
+    void buildFrame(const RenderParams& params, QVector<float>* samples,
+                    std::vector<quint8>& grid, QByteArray& out, qint64& sampleNs);
+    void printFrame();
+    // Bytes written; less than the frame when the terminal stalled past one frame interval
+    qint64 writeFrame(const QByteArray& frame);
+    void adaptToWriteTime(double writeMs, qint64 bytes);
     void printHelp();
 
     class scpDataSource* m_source = nullptr;
@@ -47,6 +94,35 @@ private:
     QTextStream m_out;
     QTextStream m_in;
 
+    // Double-buffered rendering: the worker builds into m_backBuffer and swaps
+    // it with m_frontBuffer; the main thread only swaps out and writes.
+    TerminalRenderWorker* m_renderWorker = nullptr;
+    QMutex m_renderMutex;
+    QWaitCondition m_renderCond;
+    RenderParams m_pendingParams;
+    bool m_frameRequested = false;
+    bool m_frameReady = false;
+    QByteArray m_backBuffer;
+    QByteArray m_frontBuffer;
+    QByteArray m_writeBuffer;  // Main thread only
+    // Production time of the stalest trace in each buffer, swapped along with it
+    qint64 m_backSampleNs = 0;
+    qint64 m_frontSampleNs = 0;
+    qint64 m_writeSampleNs = 0;
+    qint64 m_lastShownSampleNs = 0;
+    class scpThroughputMonitor* m_monitor = nullptr;
+
+    // Output throughput tracking for the adaptive frame rate
+    static constexpr int kBaseFrameIntervalMs = 200;
+    static constexpr int kMaxFrameIntervalMs = 2000;
+    bool m_adaptive = true;
+    int m_frameIntervalMs = kBaseFrameIntervalMs;
+    int m_resolutionLevel = 0;   // Index into the frame size table, 0 = full size
+    double m_writeMsAvg = 0.0;   // Smoothed time spent in write() per frame
+    double m_outputBytesPerSec = 0.0;
+    bool m_frameCut = false;     // Last frame stopped mid-way, maybe inside an escape or glyph
+    int m_fastFrames = 0;        // Consecutive frames with a lightly loaded link
+
 #ifdef Q_OS_UNIX
     class QSocketNotifier* m_stdinNotifier = nullptr;
     class QTimer* m_stdinPollTimer = nullptr;  // Polling timer for input
@@ -54,3 +130,18 @@ private:
     class QTimer* m_stdinPollTimer = nullptr;
 #endif
 };
+
+// Worker thread that builds terminal frames off the main thread
+class TerminalRenderWorker : public QThread {
+    Q_OBJECT
+public:
+    explicit TerminalRenderWorker(scpViewTerminal* parent);
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    scpViewTerminal* m_parent;
+    std::atomic<bool> m_shouldStop{false};
+};
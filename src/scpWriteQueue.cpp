@@ -0,0 +1,138 @@
+#include "scpWriteQueue.h"
+
+scpWriteQueue::scpWriteQueue(qint64 byteBudget)
+    : m_budget(byteBudget) {
+}
+
+scpWriteQueue::~scpWriteQueue() {
+    clear();
+    for (LaneQueue& q : m_lanes) {
+        if (q.tail != &q.stub) delete q.tail;
+    }
+}
+
+void scpWriteQueue::pushNode(LaneQueue& q, Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = q.head.exchange(node, std::memory_order_acq_rel);
+    // Between the exchange and this store the consumer sees the lane end at prev;
+    // the packet becomes visible a moment later, nothing is lost
+    prev->next.store(node, std::memory_order_release);
+}
+
+const QByteArray* scpWriteQueue::peek(const LaneQueue& q) const {
+    Node* next = q.tail->next.load(std::memory_order_acquire);
+    return next ? &next->data : nullptr;
+}
+
+bool scpWriteQueue::take(LaneQueue& q, QByteArray& out) {
+    Node* tail = q.tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (!next) return false;
+    // next becomes the new dummy head of the lane; its payload moves out
+    q.tail = next;
+    out = std::move(next->data);
+    next->data = QByteArray();
+    if (tail != &q.stub) delete tail;
+    return true;
+}
+
+void scpWriteQueue::release(qint64 bytes) {
+    m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    m_packets.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void scpWriteQueue::countDrop(qint64 bytes) {
+    m_droppedPackets.fetch_add(1, std::memory_order_relaxed);
+    m_droppedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+bool scpWriteQueue::push(const QByteArray& data, Lane lane) {
+    if (data.isEmpty()) return true;
+
+    // Reserve the bytes first so concurrent producers cannot overshoot the limit together
+    const qint64 size = data.size();
+    const qint64 budget = m_budget.load(std::memory_order_relaxed);
+    const bool dropOldest = m_dropOldest.load(std::memory_order_relaxed);
+    // Control packets and drop-oldest bulk may borrow up to a second budget until trimmed
+    const qint64 limit = (lane == ControlLane || dropOldest) ? 2 * budget : budget;
+    const qint64 total = m_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    if (total > limit && total != size) {
+        // A single oversized packet into an empty queue is still accepted
+        m_bytes.fetch_sub(size, std::memory_order_relaxed);
+        countDrop(size);
+        return false;
+    }
+    m_packets.fetch_add(1, std::memory_order_relaxed);
+
+    Node* node = new Node;
+    node->data = data;  // Implicitly shared, not copied
+    pushNode(m_lanes[lane], node);
+    return true;
+}
+
+bool scpWriteQueue::pop(QByteArray& out, Lane* lane) {
+    for (Lane l : {ControlLane, BulkLane}) {
+        if (take(m_lanes[l], out)) {
+            release(out.size());
+            if (lane) *lane = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool scpWriteQueue::popCoalesced(int chunkBytes, QByteArray& out, Lane* lane) {
+    if (take(m_lanes[ControlLane], out)) {
+        release(out.size());
+        if (lane) *lane = ControlLane;
+        return true;
+    }
+
+    LaneQueue& bulk = m_lanes[BulkLane];
+    if (!take(bulk, out)) return false;
+    release(out.size());
+    if (lane) *lane = BulkLane;
+
+    // Large packets go out as they are (still shared); small ones are merged
+    const QByteArray* next = peek(bulk);
+    if (out.size() >= chunkBytes || !next || out.size() + next->size() > chunkBytes) {
+        return true;
+    }
+    QByteArray merged;
+    merged.reserve(chunkBytes);
+    merged.append(out);
+    QByteArray piece;
+    while ((next = peek(bulk)) && merged.size() + next->size() <= chunkBytes) {
+        take(bulk, piece);
+        release(piece.size());
+        merged.append(piece);
+        m_coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+    out = merged;
+    return true;
+}
+
+int scpWriteQueue::trimToBudget() {
+    const qint64 budget = m_budget.load(std::memory_order_relaxed);
+    int dropped = 0;
+    QByteArray victim;
+    while (m_bytes.load(std::memory_order_relaxed) > budget && take(m_lanes[BulkLane], victim)) {
+        release(victim.size());
+        countDrop(victim.size());
+        ++dropped;
+    }
+    return dropped;
+}
+
+void scpWriteQueue::clear() {
+    // Discarded on purpose (close/clearQueue), so not counted as drops
+    QByteArray data;
+    while (pop(data)) {
+    }
+}
+
+void scpWriteQueue::resetStatistics() {
+    m_droppedPackets.store(0, std::memory_order_relaxed);
+    m_droppedBytes.store(0, std::memory_order_relaxed);
+    m_coalesced.store(0, std::memory_order_relaxed);
+}
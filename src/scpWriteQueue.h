@@ -0,0 +1,89 @@
+#pragma once
+#include <QByteArray>
+#include <atomic>
+
+/**
+ * @brief Lock-free multi-producer, single-consumer queue of write packets
+ *
+ * Any thread may push(); exactly one thread (the one draining the queue
+ * into the writer) may call the consumer methods: pop(), popCoalesced(),
+ * trimToBudget() and clear(). Each lane is an intrusive MPSC linked list
+ * (one atomic exchange per push, no lock, no CAS loop).
+ *
+ * Two lanes: ControlLane packets are always handed out before BulkLane
+ * packets and are never dropped to make room.
+ *
+ * Memory is bounded by bytes, not packet count. With drop-oldest enabled a
+ * bulk push is admitted while the queue stays under twice the budget, and
+ * the consumer's trimToBudget() then discards the oldest bulk packets until
+ * it is back within the budget. Without it, a push that would exceed the
+ * budget is rejected. Every packet that is not delivered is counted in
+ * droppedPackets()/droppedBytes() exactly once.
+ */
+class scpWriteQueue {
+public:
+    enum Lane {
+        BulkLane,       // Sample/bulk data: coalesced, dropped first
+        ControlLane     // Commands: sent ahead of bulk, never dropped to make room
+    };
+
+    explicit scpWriteQueue(qint64 byteBudget = 1024 * 1024);
+    ~scpWriteQueue();
+
+    scpWriteQueue(const scpWriteQueue&) = delete;
+    scpWriteQueue& operator=(const scpWriteQueue&) = delete;
+
+    // Configuration
+    void setByteBudget(qint64 bytes) { m_budget.store(bytes, std::memory_order_relaxed); }
+    qint64 byteBudget() const { return m_budget.load(std::memory_order_relaxed); }
+    void setDropOldest(bool enable) { m_dropOldest.store(enable, std::memory_order_relaxed); }
+    bool dropOldest() const { return m_dropOldest.load(std::memory_order_relaxed); }
+
+    // Producer side (any thread); false if the packet was rejected and counted as dropped
+    bool push(const QByteArray& data, Lane lane = BulkLane);
+
+    // Consumer side (single thread)
+    bool pop(QByteArray& out, Lane* lane = nullptr);
+    // Next control packet, or bulk packets merged up to chunkBytes (larger ones pass through)
+    bool popCoalesced(int chunkBytes, QByteArray& out, Lane* lane = nullptr);
+    // Drops the oldest bulk packets while over budget; returns how many were dropped
+    int trimToBudget();
+    void clear();
+
+    // Statistics (any thread)
+    qint64 queuedBytes() const { return m_bytes.load(std::memory_order_relaxed); }
+    int queuedPackets() const { return m_packets.load(std::memory_order_relaxed); }
+    qint64 droppedPackets() const { return m_droppedPackets.load(std::memory_order_relaxed); }
+    qint64 droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+    qint64 coalescedPackets() const { return m_coalesced.load(std::memory_order_relaxed); }
+    void resetStatistics();
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        QByteArray data;
+    };
+
+    // Vyukov-style intrusive queue: producers swap the head, the consumer owns the tail
+    struct LaneQueue {
+        std::atomic<Node*> head;
+        Node* tail;
+        Node stub;
+        LaneQueue() : head(&stub), tail(&stub) {}
+    };
+
+    void pushNode(LaneQueue& q, Node* node);
+    const QByteArray* peek(const LaneQueue& q) const;
+    bool take(LaneQueue& q, QByteArray& out);
+    void release(qint64 bytes);
+    void countDrop(qint64 bytes);
+
+    LaneQueue m_lanes[2];
+    std::atomic<qint64> m_budget;
+    std::atomic<bool> m_dropOldest{true};
+    std::atomic<qint64> m_bytes{0};
+    std::atomic<int> m_packets{0};
+    std::atomic<qint64> m_droppedPackets{0};
+    std::atomic<qint64> m_droppedBytes{0};
+    std::atomic<qint64> m_coalesced{0};
+};
@@ -26,24 +26,47 @@ public:
     
     void runTest(const QString& inputFile, const QString& outputFile,
                  double readFreq, int readBytes,
-                 double writeFreq, int writeBytes) {
+                 double writeFreq, int writeBytes,
+                 bool threaded, double throughput,
+                 bool mmapReplay, bool loopReplay, bool ioUring,
+                 bool frameIn, bool frameOut, bool paced, double writeRate) {
         
         qDebug() << "=== FTDI Interface Test ===";
         qDebug() << "Input file:" << inputFile;
         qDebug() << "Output file:" << outputFile;
         qDebug() << "Read frequency:" << readFreq << "Hz, Bytes/read:" << readBytes;
         qDebug() << "Write frequency:" << writeFreq << "Hz, Bytes/write:" << writeBytes;
+        if (threaded) {
+            qDebug() << "Threaded reader, target throughput:" << throughput << "bytes/s";
+        }
+        if (paced) {
+            qDebug() << "Paced writer, target rate:" << writeRate << "bytes/s (0 = write-freq x write-bytes)";
+        }
         qDebug() << "";
         
         // Configure reader (reqfRead)
         m_reader->setDevicePath(inputFile);
         m_reader->setSamplingFrequency(readFreq);
         m_reader->setBytesPerRead(readBytes);
+        m_reader->setMemoryMappedReplay(mmapReplay);
+        m_reader->setLoopReplay(loopReplay);
+        m_reader->setIoUring(ioUring);
+        m_reader->setFraming(frameIn);
+        if (threaded) {
+            m_reader->setTargetThroughput(throughput);
+            m_reader->setReadMode(scpFTDIReader::ThreadedMode);
+        }
         
         // Configure writer (reqfWrite)
         m_writer->setDevicePath(outputFile);
         m_writer->setOutputFrequency(writeFreq);
         m_writer->setBytesPerWrite(writeBytes);
+        m_writer->setIoUring(ioUring);
+        m_writer->setFraming(frameOut);
+        if (paced) {
+            m_writer->setTargetRate(writeRate);
+            m_writer->setWriteMode(scpFTDIWriter::PacedMode);
+        }
         
         // Open devices
         if (!m_reader->open()) {
@@ -122,6 +145,20 @@ private slots:
         qDebug() << "\n=== Test Complete ===";
         qDebug() << "Total bytes read:" << m_totalRead;
         qDebug() << "Total bytes written:" << m_totalWritten;
+        if (m_reader->framing()) {
+            qDebug() << "Frames decoded:" << m_reader->framesDecoded()
+                     << "lost:" << m_reader->framesLost()
+                     << "CRC errors:" << m_reader->frameCrcErrors();
+        }
+        if (m_writer->framing()) {
+            qDebug() << "Frames written:" << m_writer->framesEncoded();
+        }
+        if (m_writer->writeMode() == scpFTDIWriter::PacedMode) {
+            const scpFTDIWriter::PacingStats stats = m_writer->pacingStats();
+            qDebug() << "Paced rate:" << stats.achievedBytesPerSec << "of" << stats.targetBytesPerSec
+                     << "bytes/s, jitter mean" << stats.meanJitterUs << "us max" << stats.maxJitterUs
+                     << "us, missed ticks:" << stats.missedTicks;
+        }
         
         m_reader->stop();
         m_writer->stop();
@@ -170,6 +207,15 @@ int main(int argc, char* argv[]) {
     int readBytes = 256;
     double writeFreq = 500.0;   // 500 Hz
     int writeBytes = 128;
+    bool threaded = false;
+    double throughput = 0.0;    // Unpaced
+    bool mmapReplay = false;
+    bool loopReplay = false;
+    bool ioUring = false;
+    bool frameIn = false;
+    bool frameOut = false;
+    bool paced = false;
+    double writeRate = 0.0;     // From write-freq x write-bytes
     
     QStringList args = app.arguments();
     for (int i = 1; i < args.size(); ++i) {
@@ -185,6 +231,24 @@ int main(int argc, char* argv[]) {
             writeFreq = args[++i].toDouble();
         } else if (args[i] == "--write-bytes" && i + 1 < args.size()) {
             writeBytes = args[++i].toInt();
+        } else if (args[i] == "--threaded") {
+            threaded = true;
+        } else if (args[i] == "--throughput" && i + 1 < args.size()) {
+            throughput = args[++i].toDouble();
+        } else if (args[i] == "--mmap") {
+            mmapReplay = true;
+        } else if (args[i] == "--loop") {
+            loopReplay = true;
+        } else if (args[i] == "--io-uring") {
+            ioUring = true;
+        } else if (args[i] == "--frame-in") {
+            frameIn = true;
+        } else if (args[i] == "--frame-out") {
+            frameOut = true;
+        } else if (args[i] == "--paced") {
+            paced = true;
+        } else if (args[i] == "--write-rate" && i + 1 < args.size()) {
+            writeRate = args[++i].toDouble();
         } else if (args[i] == "--help" || args[i] == "-h") {
             qDebug() << "Usage:" << args[0] << "[options]";
             qDebug() << "Options:";
@@ -194,6 +258,15 @@ int main(int argc, char* argv[]) {
             qDebug() << "  --read-bytes <n>     Bytes per read (default: 256)";
             qDebug() << "  --write-freq <hz>    Write frequency in Hz (default: 500)";
             qDebug() << "  --write-bytes <n>    Bytes per write (default: 128)";
+            qDebug() << "  --threaded           Use the threaded blocking-read reader";
+            qDebug() << "  --throughput <B/s>   Threaded reader target rate (default: 0 = unpaced)";
+            qDebug() << "  --mmap               Replay the input file from a memory mapping";
+            qDebug() << "  --loop               Restart the input file at EOF";
+            qDebug() << "  --io-uring           io_uring reads (threaded) and writes where available";
+            qDebug() << "  --frame-in           Input is framed: decode it and report lost frames";
+            qDebug() << "  --frame-out          Frame the output (sync, sequence, length, CRC-32C)";
+            qDebug() << "  --paced              Paced writer thread (absolute deadlines, token bucket)";
+            qDebug() << "  --write-rate <B/s>   Paced writer rate (default: write-freq x write-bytes)";
             return 0;
         }
     }
@@ -201,7 +274,9 @@ int main(int argc, char* argv[]) {
     // Create and run test
     FTDITest test;
     QTimer::singleShot(0, [&]() {
-        test.runTest(inputFile, outputFile, readFreq, readBytes, writeFreq, writeBytes);
+        test.runTest(inputFile, outputFile, readFreq, readBytes, writeFreq, writeBytes,
+                     threaded, throughput, mmapReplay, loopReplay, ioUring,
+                     frameIn, frameOut, paced, writeRate);
     });
     
     return app.exec();
@@ -0,0 +1,190 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <errno.h>
+#include <atomic>
+#include "scpSerialInterface.h"
+
+/**
+ * @brief Hardware-free test for scpSerialReader
+ *
+ * Opens a pty pair, points the reader at the slave side and streams a
+ * counting byte pattern into the master from a separate thread. The
+ * reader verifies the pattern arrives intact and reports throughput.
+ */
+class SerialTest : public QObject {
+    Q_OBJECT
+
+public:
+    SerialTest(QObject* parent = nullptr) : QObject(parent) {
+        m_reader = new scpSerialReader(this);
+
+        connect(m_reader, &scpSerialReader::dataReceived,
+                this, &SerialTest::onReaderData);
+        connect(m_reader, &scpSerialReader::statusChanged, this, [](const QString& status) {
+            qDebug() << "[READER]" << status;
+        });
+        connect(m_reader, &scpSerialReader::errorOccurred, this, [](const QString& error) {
+            qDebug() << "[READER ERROR]" << error;
+        });
+    }
+
+    ~SerialTest() override {
+        m_stopWriter = true;
+        if (m_writerThread) m_writerThread->wait();
+        if (m_masterFd >= 0) ::close(m_masterFd);
+    }
+
+    bool runTest(qint64 totalBytes, int chunkBytes, int baud) {
+        m_totalBytes = totalBytes;
+
+        m_masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (m_masterFd < 0 || grantpt(m_masterFd) != 0 || unlockpt(m_masterFd) != 0) {
+            qDebug() << "Failed to create pty pair";
+            return false;
+        }
+        const QString slavePath = QString::fromLocal8Bit(ptsname(m_masterFd));
+
+        // Raw master so the line discipline passes bytes through untouched
+        struct termios tio;
+        tcgetattr(m_masterFd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(m_masterFd, TCSANOW, &tio);
+        fcntl(m_masterFd, F_SETFL, fcntl(m_masterFd, F_GETFL) | O_NONBLOCK);
+
+        qDebug() << "=== Serial Reader Test ===";
+        qDebug() << "pty slave:" << slavePath;
+        qDebug() << "Bytes:" << totalBytes << "Chunk:" << chunkBytes << "Baud:" << baud;
+
+        m_reader->setDevicePath(slavePath);
+        m_reader->setBaudRate(baud);
+        if (!m_reader->open()) {
+            return false;
+        }
+        m_reader->start();
+
+        const int masterFd = m_masterFd;
+        m_timer.start();
+        std::atomic<bool>* stop = &m_stopWriter;
+        m_writerThread = QThread::create([masterFd, totalBytes, chunkBytes, stop]() {
+            QByteArray chunk(chunkBytes, Qt::Uninitialized);
+            qint64 sent = 0;
+            while (sent < totalBytes && !*stop) {
+                const int n = static_cast<int>(qMin<qint64>(chunkBytes, totalBytes - sent));
+                for (int i = 0; i < n; ++i) chunk[i] = static_cast<char>((sent + i) & 0xFF);
+                int off = 0;
+                while (off < n) {
+                    ssize_t w = ::write(masterFd, chunk.constData() + off, n - off);
+                    if (w < 0) {
+                        if (errno == EINTR) continue;
+                        if (errno != EAGAIN || *stop) return;
+                        // pty buffer full: let the reader catch up
+                        usleep(100);
+                        continue;
+                    }
+                    off += static_cast<int>(w);
+                }
+                sent += n;
+            }
+        });
+        m_writerThread->setParent(this);
+        m_writerThread->start();
+
+        // Guard against a stalled stream
+        QTimer::singleShot(30000, this, [this]() { finish(false); });
+        return true;
+    }
+
+private slots:
+    void onReaderData(const QByteArray& data) {
+        const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+        for (int i = 0; i < data.size(); ++i) {
+            if (bytes[i] != static_cast<uchar>((m_received + i) & 0xFF)) {
+                ++m_mismatches;
+            }
+        }
+        m_received += data.size();
+        ++m_blocks;
+
+        if (m_received >= m_totalBytes) {
+            finish(true);
+        }
+    }
+
+private:
+    void finish(bool complete) {
+        if (m_finished) return;
+        m_finished = true;
+
+        const double seconds = m_timer.nsecsElapsed() / 1e9;
+        m_stopWriter = true;
+        m_reader->stop();
+        m_reader->close();
+
+        qDebug() << "\n=== Test Complete ===";
+        qDebug() << "Received:" << m_received << "of" << m_totalBytes << "bytes in" << m_blocks << "blocks";
+        qDebug() << "Average block:" << (m_blocks ? m_received / m_blocks : 0) << "bytes";
+        qDebug() << "Throughput:" << (m_received / seconds / 1e6) << "MB/s";
+        qDebug() << "Pattern mismatches:" << m_mismatches;
+
+        const bool ok = complete && m_mismatches == 0;
+        qDebug() << (ok ? "PASS" : "FAIL");
+        QTimer::singleShot(0, QCoreApplication::instance(), [ok]() {
+            QCoreApplication::exit(ok ? 0 : 1);
+        });
+    }
+
+    scpSerialReader* m_reader;
+    QThread* m_writerThread = nullptr;
+    std::atomic<bool> m_stopWriter{false};
+    int m_masterFd = -1;
+    QElapsedTimer m_timer;
+    qint64 m_totalBytes = 0;
+    qint64 m_received = 0;
+    qint64 m_blocks = 0;
+    qint64 m_mismatches = 0;
+    bool m_finished = false;
+};
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    qint64 totalBytes = 16 * 1024 * 1024;
+    int chunkBytes = 4096;
+    int baud = 115200;      // Informational on a pty
+
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--bytes" && i + 1 < args.size()) {
+            totalBytes = args[++i].toLongLong();
+        } else if (args[i] == "--chunk" && i + 1 < args.size()) {
+            chunkBytes = args[++i].toInt();
+        } else if (args[i] == "--baud" && i + 1 < args.size()) {
+            baud = args[++i].toInt();
+        } else if (args[i] == "--help" || args[i] == "-h") {
+            qDebug() << "Usage:" << args[0] << "[options]";
+            qDebug() << "Options:";
+            qDebug() << "  --bytes <n>     Total bytes to stream (default: 16 MiB)";
+            qDebug() << "  --chunk <n>     Bytes per write into the pty master (default: 4096)";
+            qDebug() << "  --baud <rate>   Baud rate to configure (default: 115200)";
+            return 0;
+        }
+    }
+
+    SerialTest test;
+    QTimer::singleShot(0, [&]() {
+        if (!test.runTest(totalBytes, chunkBytes, baud)) {
+            QCoreApplication::exit(1);
+        }
+    });
+
+    return app.exec();
+}
+
+#include "testSerial.moc"